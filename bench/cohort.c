@@ -0,0 +1,142 @@
+/**
+ * @file cohort.c
+ *
+ * @author awewsomegamer <awewsomegamer@gmail.com>
+ *
+ * @LICENSE
+ * Arctan-OS/Klib - Generic Kernel Functions and Data Structures
+ * Copyright (C) 2023-2026 awewsomegamer
+ *
+ * This file is part of Arctan-OS/Klib.
+ *
+ * Arctan-OS/Klib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * @DESCRIPTION
+*/
+/**
+ * Cohort lock benchmark
+ *
+ * Runs threads spread over simulated memory nodes, each taking the lock
+ * a fixed number of times, and counts how often the lock moved between
+ * nodes. The same run is repeated with a plain ticket lock to compare.
+ * Holders yield every BENCH_YIELD_EVERY acquisitions, so that waiters
+ * queue up even on a host with a single processor.
+ *
+ * Usage: cohort [threads] [nodes] [iterations per thread]
+ * */
+#include "host/host.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <lib/cohort.h>
+#include <lib/percpu.h>
+#include <lib/ticket.h>
+
+#define BENCH_YIELD_EVERY 16
+
+static int bench_nodes = 2;
+static long bench_iterations = 100000;
+
+static ARC_CohortLock bench_cohort;
+static struct ARC_TicketLock bench_ticket;
+static int bench_use_cohort = 1;
+
+// Only changed with the lock held
+static long bench_acquisitions = 0;
+static long bench_node_switches = 0;
+static uint32_t bench_last_node = 0;
+
+static void *bench_thread(void *arg) {
+	host_thread_init();
+	host_set_node((long)arg % bench_nodes);
+
+	for (long i = 0; i < bench_iterations; i++) {
+		struct ARC_Ticket ticket;
+
+		if (bench_use_cohort) {
+			cohort_lock(&bench_cohort);
+		} else {
+			ticket_lock_node(&bench_ticket, &ticket);
+			ticket_lock_yield(&ticket);
+		}
+
+		if (bench_acquisitions++ != 0 && bench_last_node != host_get_node()) {
+			bench_node_switches++;
+		}
+
+		bench_last_node = host_get_node();
+
+		if (i % BENCH_YIELD_EVERY == 0) {
+			sched_yield();
+		}
+
+		if (bench_use_cohort) {
+			cohort_unlock(&bench_cohort);
+		} else {
+			ticket_unlock(&ticket);
+		}
+	}
+
+	return NULL;
+}
+
+static void bench_run(int threads) {
+	pthread_t *ids = malloc(threads * sizeof(*ids));
+
+	bench_acquisitions = 0;
+	bench_node_switches = 0;
+
+	for (long i = 0; i < threads; i++) {
+		pthread_create(&ids[i], NULL, bench_thread, (void *)i);
+	}
+
+	for (int i = 0; i < threads; i++) {
+		pthread_join(ids[i], NULL);
+	}
+
+	free(ids);
+}
+
+int main(int argc, char **argv) {
+	int threads = argc > 1 ? atoi(argv[1]) : 6;
+	bench_nodes = argc > 2 ? atoi(argv[2]) : 2;
+	bench_iterations = argc > 3 ? atol(argv[3]) : 100000;
+
+	if (threads < 1 || bench_nodes < 1 || bench_nodes > ARC_PERCPU_NODES_MAX || bench_iterations < 1) {
+		fprintf(stderr, "usage: %s [threads] [nodes (1-%d)] [iterations]\n", argv[0], ARC_PERCPU_NODES_MAX);
+		return 1;
+	}
+
+	host_init();
+	host_thread_init();
+	init_percpu_nodes(host_get_node, bench_nodes);
+
+	init_static_cohort_lock(&bench_cohort);
+	bench_use_cohort = 1;
+	bench_run(threads);
+
+	printf("cohort: %ld acquisitions, %ld node switches (%lu global handoffs, %lu local handoffs)\n",
+	       bench_acquisitions, bench_node_switches, bench_cohort.global_handoffs, bench_cohort.local_handoffs);
+
+	init_static_ticket_lock(&bench_ticket);
+	bench_use_cohort = 0;
+	bench_run(threads);
+
+	printf("ticket: %ld acquisitions, %ld node switches\n", bench_acquisitions, bench_node_switches);
+
+	return bench_acquisitions != threads * bench_iterations;
+}
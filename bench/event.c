@@ -0,0 +1,170 @@
+/**
+ * @file event.c
+ *
+ * @author awewsomegamer <awewsomegamer@gmail.com>
+ *
+ * @LICENSE
+ * Arctan-OS/Klib - Generic Kernel Functions and Data Structures
+ * Copyright (C) 2023-2026 awewsomegamer
+ *
+ * This file is part of Arctan-OS/Klib.
+ *
+ * Arctan-OS/Klib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * @DESCRIPTION
+*/
+/**
+ * Event trigger benchmark
+ *
+ * Registers an increasing number of subscribers with an event and times
+ * event_trigger for each count. Every sample is a single trigger and
+ * includes one read of the clock. Then the same event is triggered from
+ * several threads at once, to show that triggers do not serialize.
+ *
+ * Usage: event [max subscribers] [triggers per sample set]
+ * */
+#include "host/host.h"
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <lib/event.h>
+
+// Subscribers kept while triggering from several threads
+#define BENCH_SHARED_SUBSCRIBERS 16
+#define BENCH_THREADS_MAX 8
+
+static ARC_Event bench_event;
+static long bench_triggers = 0;
+static pthread_barrier_t bench_start;
+
+// Per thread, so that concurrent triggers do not share a counter
+static __thread uint64_t bench_calls = 0;
+
+static void bench_handler(void *args) {
+	(void)args;
+	bench_calls++;
+}
+
+static void bench_latency(int subscribers, uint64_t *samples) {
+	bench_calls = 0;
+
+	for (long i = 0; i < bench_triggers; i++) {
+		uint64_t start = host_now();
+		event_trigger(&bench_event, NULL);
+		samples[i] = host_now() - start;
+	}
+
+	if (bench_calls != (uint64_t)subscribers * bench_triggers) {
+		fprintf(stderr, "%d subscribers: %lu handler calls, expected %lu\n", subscribers, bench_calls,
+			(uint64_t)subscribers * bench_triggers);
+		exit(1);
+	}
+
+	char name[64];
+	snprintf(name, sizeof(name), "%4d subscribers, trigger", subscribers);
+	host_report(name, samples, bench_triggers);
+}
+
+static void *bench_thread(void *arg) {
+	(void)arg;
+
+	host_thread_init();
+	pthread_barrier_wait(&bench_start);
+
+	for (long i = 0; i < bench_triggers; i++) {
+		event_trigger(&bench_event, NULL);
+	}
+
+	return (void *)bench_calls;
+}
+
+static void bench_concurrent(int threads) {
+	pthread_t ids[BENCH_THREADS_MAX];
+	uint64_t calls = 0;
+
+	pthread_barrier_init(&bench_start, NULL, threads + 1);
+
+	for (int i = 0; i < threads; i++) {
+		pthread_create(&ids[i], NULL, bench_thread, NULL);
+	}
+
+	pthread_barrier_wait(&bench_start);
+	uint64_t start = host_now();
+
+	for (int i = 0; i < threads; i++) {
+		void *ret = NULL;
+		pthread_join(ids[i], &ret);
+		calls += (uint64_t)ret;
+	}
+
+	uint64_t elapsed = host_now() - start;
+	pthread_barrier_destroy(&bench_start);
+
+	if (calls != (uint64_t)threads * bench_triggers * BENCH_SHARED_SUBSCRIBERS) {
+		fprintf(stderr, "%d threads: %lu handler calls\n", threads, calls);
+		exit(1);
+	}
+
+	printf("%d threads, %d subscribers: %.2f M triggers/s\n", threads, BENCH_SHARED_SUBSCRIBERS,
+	       threads * bench_triggers * 1000.0 / elapsed);
+}
+
+int main(int argc, char **argv) {
+	int max = argc > 1 ? atoi(argv[1]) : 1024;
+	bench_triggers = argc > 2 ? atol(argv[2]) : 100000;
+
+	if (max < BENCH_SHARED_SUBSCRIBERS || bench_triggers < 1) {
+		fprintf(stderr, "usage: %s [max subscribers (>= %d)] [triggers]\n", argv[0], BENCH_SHARED_SUBSCRIBERS);
+		return 1;
+	}
+
+	host_init();
+	host_thread_init();
+	init_static_event(&bench_event);
+
+	ARC_EventElement *elems = calloc(max, sizeof(*elems));
+	uint64_t *samples = malloc(bench_triggers * sizeof(*samples));
+	int registered = 0;
+
+	for (int count = 1; count <= max; count *= 4) {
+		for (; registered < count; registered++) {
+			elems[registered].handler = bench_handler;
+			elems[registered].priority = registered % 8;
+			event_register(&bench_event, &elems[registered]);
+		}
+
+		bench_latency(count, samples);
+	}
+
+	// Back down to the shared count, which also times unregistering
+	uint64_t start = host_now();
+	int removed = registered - BENCH_SHARED_SUBSCRIBERS;
+
+	while (registered > BENCH_SHARED_SUBSCRIBERS) {
+		event_unregister(&bench_event, &elems[--registered]);
+	}
+
+	printf("unregistered %d subscribers, %lu ns each\n", removed, removed > 0 ? (host_now() - start) / removed : 0);
+
+	for (int threads = 1; threads <= BENCH_THREADS_MAX; threads *= 2) {
+		bench_concurrent(threads);
+	}
+
+	free(samples);
+	free(elems);
+
+	return 0;
+}
@@ -0,0 +1,271 @@
+/**
+ * @file host.c
+ *
+ * @author awewsomegamer <awewsomegamer@gmail.com>
+ *
+ * @LICENSE
+ * Arctan-OS/Klib - Generic Kernel Functions and Data Structures
+ * Copyright (C) 2023-2026 awewsomegamer
+ *
+ * This file is part of Arctan-OS/Klib.
+ *
+ * Arctan-OS/Klib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * @DESCRIPTION
+*/
+#define _GNU_SOURCE
+#include "host.h"
+
+#include <pthread.h>
+#include <semaphore.h>
+#include <sched.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include <userspace/thread.h>
+#include <lib/pimutex.h>
+
+#define HOST_THREADS_MAX 4096
+
+// NOTE: The ARC_Thread comes first, so that the thread's pointer can be
+//       turned back into its entry
+struct host_thread {
+	ARC_Thread thread;
+	sem_t permit;
+	pthread_t pthread;
+	int priority;
+	int blocked;
+	ARC_PIState pi;
+};
+
+static struct host_thread host_threads[HOST_THREADS_MAX];
+static int host_thread_count = 0;
+static bool host_rt = false;
+
+static __thread struct host_thread *host_self = NULL;
+static __thread uint32_t host_cpu = 0;
+static __thread uint32_t host_node = 0;
+__thread int host_interrupts = 1;
+
+// klib's sources are built with free and sched_yield renamed, as the
+// kernel's versions clash with the C library's
+void *alloc(size_t size) {
+	return calloc(1, size);
+}
+
+void *host_free(void *address) {
+	free(address);
+	return NULL;
+}
+
+int host_sched_yield(ARC_Thread *thread) {
+	(void)thread;
+	sched_yield();
+	return 0;
+}
+
+ARC_Thread *sched_current_thread() {
+	return &host_self->thread;
+}
+
+bool arch_interrupts_enabled() {
+	return host_interrupts;
+}
+
+uint64_t host_now() {
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	return now.tv_sec * 1000000000ull + now.tv_nsec;
+}
+
+static uint64_t host_cpu_now() {
+	struct timespec now;
+	clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+
+	return now.tv_sec * 1000000000ull + now.tv_nsec;
+}
+
+void host_busy(uint64_t ns) {
+	// NOTE: Counted in CPU time of the calling thread, so time spent
+	//       preempted does not count as work done
+	uint64_t until = host_cpu_now() + ns;
+
+	while (host_cpu_now() < until);
+}
+
+static int host_wait(uint64_t deadline) {
+	if (deadline == 0) {
+		while (sem_wait(&host_self->permit) != 0);
+		return 0;
+	}
+
+	uint64_t now = host_now();
+
+	if (deadline <= now) {
+		return -1;
+	}
+
+	struct timespec until;
+	clock_gettime(CLOCK_REALTIME, &until);
+	until.tv_sec += (deadline - now) / 1000000000;
+	until.tv_nsec += (deadline - now) % 1000000000;
+
+	if (until.tv_nsec >= 1000000000) {
+		until.tv_sec++;
+		until.tv_nsec -= 1000000000;
+	}
+
+	return sem_timedwait(&host_self->permit, &until) == 0 ? 0 : -1;
+}
+
+static int host_block(uint64_t deadline) {
+	__atomic_store_n(&host_self->blocked, 1, __ATOMIC_RELAXED);
+	int r = host_wait(deadline);
+	__atomic_store_n(&host_self->blocked, 0, __ATOMIC_RELAXED);
+
+	return r;
+}
+
+static int host_unblock(ARC_Thread *thread) {
+	struct host_thread *entry = (struct host_thread *)thread;
+	int permits = 0;
+
+	// Like the kernel's unblock, wakes pending on a running thread do
+	// not add up
+	sem_getvalue(&entry->permit, &permits);
+	if (permits < 1) {
+		sem_post(&entry->permit);
+	}
+
+	return 0;
+}
+
+static int host_on_cpu(ARC_Thread *thread) {
+	// NOTE: Any thread not blocked in the block hook counts as running.
+	//       That is only true with a processor for each thread, with
+	//       fewer an owner which is spun on may be preempted
+	return !__atomic_load_n(&((struct host_thread *)thread)->blocked, __ATOMIC_RELAXED);
+}
+
+static int host_get_priority(ARC_Thread *thread) {
+	return ((struct host_thread *)thread)->priority;
+}
+
+static int host_set_priority_hook(ARC_Thread *thread, int priority) {
+	struct host_thread *entry = (struct host_thread *)thread;
+	entry->priority = priority;
+
+	if (!host_rt) {
+		return 0;
+	}
+
+	struct sched_param param = { .sched_priority = HOST_RT_BASE + priority };
+
+	return pthread_setschedparam(entry->pthread, SCHED_FIFO, &param) == 0 ? 0 : 1;
+}
+
+static ARC_PIState *host_pi_state(ARC_Thread *thread) {
+	return &((struct host_thread *)thread)->pi;
+}
+
+void host_hooks(ARC_SchedHooks *hooks) {
+	*hooks = (ARC_SchedHooks){
+		.on_cpu = host_on_cpu,
+		.block = host_block,
+		.unblock = host_unblock,
+		.now = host_now,
+		.get_priority = host_get_priority,
+		.set_priority = host_set_priority_hook,
+		.pi_state = host_pi_state,
+	};
+}
+
+void host_init() {
+	ARC_SchedHooks hooks;
+	host_hooks(&hooks);
+
+	init_sched_hooks(&hooks);
+}
+
+void host_thread_init() {
+	int idx = __atomic_fetch_add(&host_thread_count, 1, __ATOMIC_RELAXED);
+
+	if (idx >= HOST_THREADS_MAX) {
+		abort();
+	}
+
+	host_self = &host_threads[idx];
+	host_self->thread.tid = idx;
+	host_self->pthread = pthread_self();
+	sem_init(&host_self->permit, 0, 0);
+}
+
+int host_realtime() {
+	cpu_set_t cpus;
+	CPU_ZERO(&cpus);
+	CPU_SET(0, &cpus);
+
+	// Threads started later inherit both
+	struct sched_param param = { .sched_priority = HOST_RT_BASE + HOST_RT_MAX };
+	if (sched_setaffinity(0, sizeof(cpus), &cpus) != 0
+	    || pthread_setschedparam(pthread_self(), SCHED_FIFO, &param) != 0) {
+		return -1;
+	}
+
+	host_rt = true;
+
+	return 0;
+}
+
+void host_set_priority(int priority) {
+	host_set_priority_hook(&host_self->thread, priority);
+}
+
+void host_set_cpu(uint32_t cpu) {
+	host_cpu = cpu;
+}
+
+uint32_t host_get_cpu() {
+	return host_cpu;
+}
+
+void host_set_node(uint32_t node) {
+	host_node = node;
+}
+
+uint32_t host_get_node() {
+	return host_node;
+}
+
+static int host_compare(const void *a, const void *b) {
+	uint64_t x = *(const uint64_t *)a;
+	uint64_t y = *(const uint64_t *)b;
+
+	return x < y ? -1 : x > y;
+}
+
+void host_report(const char *name, uint64_t *samples, size_t count) {
+	if (count == 0) {
+		printf("%s: no samples\n", name);
+		return;
+	}
+
+	qsort(samples, count, sizeof(*samples), host_compare);
+
+	printf("%s: %zu samples, p50 %lu ns, p90 %lu ns, p99 %lu ns, max %lu ns\n", name, count,
+	       samples[count / 2], samples[count * 9 / 10], samples[count * 99 / 100], samples[count - 1]);
+}
@@ -0,0 +1,85 @@
+/**
+ * @file host.h
+ *
+ * @author awewsomegamer <awewsomegamer@gmail.com>
+ *
+ * @LICENSE
+ * Arctan-OS/Klib - Generic Kernel Functions and Data Structures
+ * Copyright (C) 2023-2026 awewsomegamer
+ *
+ * This file is part of Arctan-OS/Klib.
+ *
+ * Arctan-OS/Klib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * @DESCRIPTION
+*/
+#ifndef ARC_BENCH_HOST_H
+#define ARC_BENCH_HOST_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <lib/schedhooks.h>
+
+/**
+ * Hosted stand-ins for the kernel services klib relies on
+ *
+ * Threads are POSIX threads. Each one gets an ARC_Thread and a
+ * semaphore which the block and unblock scheduler hooks wait on and
+ * post, and a thread counts as running unless it waits on its semaphore.
+ * Processor and node IDs are whatever the benchmark sets for the
+ * calling thread. Priorities are only recorded, unless host_realtime
+ * turned them into real-time scheduling priorities.
+ * */
+
+/// SCHED_FIFO priority given to klib priority 0 by host_realtime
+#define HOST_RT_BASE 10
+/// Highest klib priority used with host_realtime
+#define HOST_RT_MAX 50
+
+/// Fill in the default scheduler hooks, for benchmarks which change some
+void host_hooks(ARC_SchedHooks *hooks);
+/// Install the scheduler hooks, called once before any thread is started
+void host_init();
+/// Give the calling thread its ARC_Thread, called first by every thread
+void host_thread_init();
+
+/**
+ * Run every thread started from now on on processor 0 with real-time
+ * priorities, so that priorities set through the hooks decide which
+ * thread runs. Called by the main thread, which gets the highest
+ * priority. Returns -1 if the host does not allow it.
+ * */
+int host_realtime();
+/// Set the priority of the calling thread
+void host_set_priority(int priority);
+
+/// Set the processor percpu_id() returns for the calling thread
+void host_set_cpu(uint32_t cpu);
+/// Processor of the calling thread, to be passed to init_percpu
+uint32_t host_get_cpu();
+
+/// Set the node percpu_node() returns for the calling thread
+void host_set_node(uint32_t node);
+/// Node of the calling thread, to be passed to init_percpu_nodes
+uint32_t host_get_node();
+
+/// Monotonic time in nanoseconds
+uint64_t host_now();
+/// Keep the processor busy for the given CPU time of the calling thread
+void host_busy(uint64_t ns);
+/// Print the percentiles of a set of nanosecond samples, sorting them
+void host_report(const char *name, uint64_t *samples, size_t count);
+
+#endif
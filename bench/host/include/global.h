@@ -0,0 +1,41 @@
+/**
+ * @file global.h
+ *
+ * @author awewsomegamer <awewsomegamer@gmail.com>
+ *
+ * @LICENSE
+ * Arctan-OS/Klib - Generic Kernel Functions and Data Structures
+ * Copyright (C) 2023-2026 awewsomegamer
+ *
+ * This file is part of Arctan-OS/Klib.
+ *
+ * Arctan-OS/Klib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * @DESCRIPTION
+*/
+#ifndef ARC_BENCH_GLOBAL_H
+#define ARC_BENCH_GLOBAL_H
+
+// Hosted stand-in for the kernel's global.h, for the benchmarks only
+
+#include <stdio.h>
+#include <stddef.h>
+
+#define ARC_DEBUG(__level, ...) printf(__VA_ARGS__)
+#define ARC_HANG for (;;)
+
+#define min(__a, __b) ((__a) < (__b) ? (__a) : (__b))
+#define max(__a, __b) ((__a) > (__b) ? (__a) : (__b))
+
+#endif
@@ -0,0 +1,41 @@
+/**
+ * @file util.h
+ *
+ * @author awewsomegamer <awewsomegamer@gmail.com>
+ *
+ * @LICENSE
+ * Arctan-OS/Klib - Generic Kernel Functions and Data Structures
+ * Copyright (C) 2023-2026 awewsomegamer
+ *
+ * This file is part of Arctan-OS/Klib.
+ *
+ * Arctan-OS/Klib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * @DESCRIPTION
+*/
+#ifndef ARC_BENCH_UTIL_H
+#define ARC_BENCH_UTIL_H
+
+// Hosted stand-in for the kernel's util.h. Interrupts cannot be masked
+// in a user process, the flag is only tracked per thread
+
+#include "global.h"
+#include "lib/atomics.h"
+
+extern __thread int host_interrupts;
+
+#define ARC_DISABLE_INTERRUPT host_interrupts = 0;
+#define ARC_ENABLE_INTERRUPT host_interrupts = 1;
+
+#endif
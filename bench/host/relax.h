@@ -0,0 +1,42 @@
+/**
+ * @file relax.h
+ *
+ * @author awewsomegamer <awewsomegamer@gmail.com>
+ *
+ * @LICENSE
+ * Arctan-OS/Klib - Generic Kernel Functions and Data Structures
+ * Copyright (C) 2023-2026 awewsomegamer
+ *
+ * This file is part of Arctan-OS/Klib.
+ *
+ * Arctan-OS/Klib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * @DESCRIPTION
+*/
+#ifndef ARC_BENCH_RELAX_H
+#define ARC_BENCH_RELAX_H
+
+// NOTE: Forced into every klib source. Unlike a kernel thread spinning
+//       with preemption disabled, a spinning process can be waiting on
+//       a holder which is not running at all, so spinning yields
+
+#include "lib/atomics.h"
+#include "userspace/thread.h"
+
+int host_sched_yield(ARC_Thread *thread);
+
+#undef ARC_CPU_RELAX
+#define ARC_CPU_RELAX host_sched_yield(NULL);
+
+#endif
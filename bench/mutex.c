@@ -0,0 +1,278 @@
+/**
+ * @file mutex.c
+ *
+ * @author awewsomegamer <awewsomegamer@gmail.com>
+ *
+ * @LICENSE
+ * Arctan-OS/Klib - Generic Kernel Functions and Data Structures
+ * Copyright (C) 2023-2026 awewsomegamer
+ *
+ * This file is part of Arctan-OS/Klib.
+ *
+ * Arctan-OS/Klib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * @DESCRIPTION
+*/
+/**
+ * Mutex handoff benchmark
+ *
+ * Runs threads which take a mutex in turn and work inside it for a
+ * short and for a long critical section. For each lock the throughput
+ * is reported, along with the handoff latency: the time from one thread
+ * unlocking to another thread holding the mutex. Holders yield every
+ * BENCH_YIELD_EVERY acquisitions, so that waiters queue up even on a
+ * host with a single processor.
+ *
+ * Locks compared:
+ *  - adaptive: ARC_Mutex, spinning on a running owner before sleeping
+ *  - sleeping: ARC_Mutex with spinning disabled (an on_cpu hook which
+ *    reports every owner as not running)
+ *  - yielding: the test-and-set and yield loop ARC_Mutex used before it
+ *    spun or slept, kept here as a baseline
+ *  - list: ARC_ListMutex, which hands the mutex to the next waiter in
+ *    the queue and wakes only it
+ *  - polling: the same queue with waiters yielding until they are at
+ *    the head, the way ARC_ListMutex waited before direct handoff
+ *
+ * Usage: mutex [threads] [acquisitions per thread]
+ * */
+#include "host/host.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <lib/mutex.h>
+
+// Work done inside the critical section, in nanoseconds of CPU time
+#define BENCH_SHORT 100
+#define BENCH_LONG  20000
+#define BENCH_YIELD_EVERY 16
+
+struct bench_lock {
+	const char *name;
+	// Spin on a running owner, only used by ARC_Mutex
+	int spin;
+	void (*init)();
+	void (*lock)();
+	void (*unlock)();
+};
+
+static ARC_Mutex bench_mutex;
+static uint64_t bench_yield_word;
+static ARC_ListMutex bench_list;
+static ARC_ListMutexElement *bench_poll_last;
+static __thread ARC_ListMutexElement bench_elem;
+
+static const struct bench_lock *bench_current = NULL;
+static long bench_iterations = 10000;
+static uint64_t bench_work = 0;
+static pthread_barrier_t bench_start;
+
+// Only changed with the lock held
+static long bench_acquisitions = 0;
+static long bench_handoffs = 0;
+static int bench_holder = -1;
+static uint64_t bench_released = 0;
+static uint64_t *bench_samples = NULL;
+
+static void bench_mutex_init() {
+	init_static_mutex(&bench_mutex);
+}
+
+static void bench_mutex_lock() {
+	mutex_lock(&bench_mutex);
+}
+
+static void bench_mutex_unlock() {
+	mutex_unlock(&bench_mutex);
+}
+
+static void bench_yield_init() {
+	bench_yield_word = 0;
+}
+
+static void bench_yield_lock() {
+	while (__atomic_test_and_set(&bench_yield_word, __ATOMIC_ACQUIRE)) {
+		sched_yield();
+	}
+}
+
+static void bench_yield_unlock() {
+	__atomic_clear(&bench_yield_word, __ATOMIC_RELEASE);
+}
+
+static void bench_list_init() {
+	init_static_list_mutex(&bench_list);
+}
+
+static void bench_list_lock() {
+	list_mutex_lock(&bench_list, &bench_elem);
+}
+
+static void bench_list_unlock() {
+	list_mutex_unlock(&bench_list);
+}
+
+static void bench_poll_init() {
+	bench_poll_last = NULL;
+}
+
+static void bench_poll_lock() {
+	bench_elem.next = NULL;
+	bench_elem.granted = 0;
+
+	ARC_ListMutexElement *prev = __atomic_exchange_n(&bench_poll_last, &bench_elem, __ATOMIC_ACQ_REL);
+	if (prev == NULL) {
+		return;
+	}
+
+	__atomic_store_n(&prev->next, &bench_elem, __ATOMIC_RELEASE);
+
+	while (!__atomic_load_n(&bench_elem.granted, __ATOMIC_ACQUIRE)) {
+		sched_yield();
+	}
+}
+
+static void bench_poll_unlock() {
+	ARC_ListMutexElement *next = __atomic_load_n(&bench_elem.next, __ATOMIC_ACQUIRE);
+
+	if (next == NULL) {
+		ARC_ListMutexElement *expected = &bench_elem;
+		if (__atomic_compare_exchange_n(&bench_poll_last, &expected, NULL, 0, __ATOMIC_RELEASE, __ATOMIC_RELAXED)) {
+			return;
+		}
+
+		while ((next = __atomic_load_n(&bench_elem.next, __ATOMIC_ACQUIRE)) == NULL) {
+			sched_yield();
+		}
+	}
+
+	// The next waiter notices on its own the next time it runs
+	__atomic_store_n(&next->granted, 1, __ATOMIC_RELEASE);
+}
+
+static const struct bench_lock bench_locks[] = {
+	{ "adaptive", 1, bench_mutex_init, bench_mutex_lock, bench_mutex_unlock },
+	{ "sleeping", 0, bench_mutex_init, bench_mutex_lock, bench_mutex_unlock },
+	{ "yielding", 0, bench_yield_init, bench_yield_lock, bench_yield_unlock },
+	{ "list", 0, bench_list_init, bench_list_lock, bench_list_unlock },
+	{ "polling", 0, bench_poll_init, bench_poll_lock, bench_poll_unlock },
+};
+
+static int bench_no_spin(ARC_Thread *thread) {
+	(void)thread;
+	return 0;
+}
+
+static void *bench_thread(void *arg) {
+	int id = (int)(long)arg;
+
+	host_thread_init();
+	pthread_barrier_wait(&bench_start);
+
+	for (long i = 0; i < bench_iterations; i++) {
+		bench_current->lock();
+
+		if (bench_holder != -1 && bench_holder != id) {
+			bench_samples[bench_handoffs++] = host_now() - bench_released;
+		}
+
+		bench_holder = id;
+		bench_acquisitions++;
+		host_busy(bench_work);
+
+		if (i % BENCH_YIELD_EVERY == 0) {
+			sched_yield();
+		}
+
+		bench_released = host_now();
+		bench_current->unlock();
+	}
+
+	return NULL;
+}
+
+static void bench_run(const struct bench_lock *lock, int threads, uint64_t work, long iterations) {
+	pthread_t *ids = malloc(threads * sizeof(*ids));
+
+	ARC_SchedHooks hooks;
+	host_hooks(&hooks);
+	if (!lock->spin) {
+		hooks.on_cpu = bench_no_spin;
+	}
+	init_sched_hooks(&hooks);
+
+	lock->init();
+	bench_current = lock;
+	bench_iterations = iterations;
+	bench_work = work;
+	bench_acquisitions = 0;
+	bench_handoffs = 0;
+	bench_holder = -1;
+	bench_samples = malloc(threads * iterations * sizeof(*bench_samples));
+
+	pthread_barrier_init(&bench_start, NULL, threads + 1);
+
+	for (long i = 0; i < threads; i++) {
+		pthread_create(&ids[i], NULL, bench_thread, (void *)i);
+	}
+
+	pthread_barrier_wait(&bench_start);
+	uint64_t start = host_now();
+
+	for (int i = 0; i < threads; i++) {
+		pthread_join(ids[i], NULL);
+	}
+
+	uint64_t elapsed = host_now() - start;
+
+	if (bench_acquisitions != threads * iterations) {
+		fprintf(stderr, "%s: %ld of %ld acquisitions\n", lock->name, bench_acquisitions, threads * iterations);
+		exit(1);
+	}
+
+	char name[80];
+	snprintf(name, sizeof(name), "%-8s %5lu ns, %8.0f acq/s, handoff", lock->name, work,
+		 bench_acquisitions * 1e9 / elapsed);
+	host_report(name, bench_samples, bench_handoffs);
+
+	pthread_barrier_destroy(&bench_start);
+	free(bench_samples);
+	free(ids);
+}
+
+int main(int argc, char **argv) {
+	int threads = argc > 1 ? atoi(argv[1]) : 4;
+	long iterations = argc > 2 ? atol(argv[2]) : 20000;
+
+	if (threads < 1 || iterations < 1) {
+		fprintf(stderr, "usage: %s [threads] [acquisitions per thread]\n", argv[0]);
+		return 1;
+	}
+
+	host_thread_init();
+
+	for (size_t i = 0; i < sizeof(bench_locks) / sizeof(*bench_locks); i++) {
+		bench_run(&bench_locks[i], threads, BENCH_SHORT, iterations);
+	}
+
+	// Long sections take a while, do fewer of them
+	for (size_t i = 0; i < sizeof(bench_locks) / sizeof(*bench_locks); i++) {
+		bench_run(&bench_locks[i], threads, BENCH_LONG, iterations / 10 + 1);
+	}
+
+	return 0;
+}
@@ -0,0 +1,192 @@
+/**
+ * @file pimutex.c
+ *
+ * @author awewsomegamer <awewsomegamer@gmail.com>
+ *
+ * @LICENSE
+ * Arctan-OS/Klib - Generic Kernel Functions and Data Structures
+ * Copyright (C) 2023-2026 awewsomegamer
+ *
+ * This file is part of Arctan-OS/Klib.
+ *
+ * Arctan-OS/Klib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * @DESCRIPTION
+*/
+/**
+ * Priority inversion benchmark for ARC_PIMutex
+ *
+ * Three threads share processor 0 under real-time scheduling. The low
+ * priority thread takes the mutex and works for BENCH_LOW_WORK. While
+ * it holds it, the high priority thread blocks on the mutex, then the
+ * medium priority thread starts BENCH_MEDIUM_WORK of unrelated work.
+ * Without inheritance the medium thread preempts the owner, and the
+ * high priority thread waits for both. With inheritance the owner runs
+ * at high priority and the wait is bounded by BENCH_LOW_WORK. The time
+ * the high priority thread waits is reported for both cases.
+ *
+ * Needs permission to use SCHED_FIFO (root or CAP_SYS_NICE).
+ *
+ * Usage: pimutex [rounds]
+ * */
+#include "host/host.h"
+
+#include <pthread.h>
+#include <semaphore.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include <lib/pimutex.h>
+
+#define BENCH_LOW    1
+#define BENCH_MEDIUM 2
+#define BENCH_HIGH   3
+
+#define BENCH_LOW_WORK    1000000
+#define BENCH_MEDIUM_WORK 10000000
+
+// Time the high priority thread is given to block on the mutex
+#define BENCH_SETTLE 200000
+
+static ARC_PIMutex bench_mutex;
+static int bench_rounds = 20;
+
+static sem_t bench_go[3];
+static sem_t bench_held;
+static sem_t bench_done;
+static uint64_t *bench_waits;
+
+static void *bench_low(void *arg) {
+	host_thread_init();
+	host_set_priority(BENCH_LOW);
+
+	for (int i = 0; i < bench_rounds; i++) {
+		sem_wait(&bench_go[0]);
+		pimutex_lock(&bench_mutex);
+		sem_post(&bench_held);
+		host_busy(BENCH_LOW_WORK);
+		pimutex_unlock(&bench_mutex);
+	}
+
+	return NULL;
+}
+
+static void *bench_medium(void *arg) {
+	host_thread_init();
+	host_set_priority(BENCH_MEDIUM);
+
+	for (int i = 0; i < bench_rounds; i++) {
+		sem_wait(&bench_go[1]);
+		host_busy(BENCH_MEDIUM_WORK);
+		sem_post(&bench_done);
+	}
+
+	return NULL;
+}
+
+static void *bench_high(void *arg) {
+	host_thread_init();
+	host_set_priority(BENCH_HIGH);
+
+	for (int i = 0; i < bench_rounds; i++) {
+		sem_wait(&bench_go[2]);
+
+		uint64_t start = host_now();
+		pimutex_lock(&bench_mutex);
+		bench_waits[i] = host_now() - start;
+		pimutex_unlock(&bench_mutex);
+
+		sem_post(&bench_done);
+	}
+
+	return NULL;
+}
+
+static void bench_run(const char *name, int inherit) {
+	ARC_SchedHooks hooks;
+	host_hooks(&hooks);
+
+	// Without the per-thread state nobody is boosted
+	if (!inherit) {
+		hooks.pi_state = NULL;
+	}
+
+	init_sched_hooks(&hooks);
+	init_static_pimutex(&bench_mutex);
+
+	void *(*entries[3])(void *) = { bench_low, bench_medium, bench_high };
+	pthread_t threads[3];
+
+	for (int i = 0; i < 3; i++) {
+		pthread_create(&threads[i], NULL, entries[i], NULL);
+	}
+
+	struct timespec settle = { .tv_sec = 0, .tv_nsec = BENCH_SETTLE };
+
+	// This thread has the highest priority, it only lets the others run
+	// while it waits
+	for (int i = 0; i < bench_rounds; i++) {
+		sem_post(&bench_go[0]);
+		sem_wait(&bench_held);
+
+		sem_post(&bench_go[2]);
+		nanosleep(&settle, NULL);
+
+		sem_post(&bench_go[1]);
+		sem_wait(&bench_done);
+		sem_wait(&bench_done);
+	}
+
+	for (int i = 0; i < 3; i++) {
+		pthread_join(threads[i], NULL);
+	}
+
+	host_report(name, bench_waits, bench_rounds);
+}
+
+int main(int argc, char **argv) {
+	bench_rounds = argc > 1 ? atoi(argv[1]) : 20;
+
+	if (bench_rounds < 1) {
+		fprintf(stderr, "usage: %s [rounds]\n", argv[0]);
+		return 1;
+	}
+
+	host_thread_init();
+
+	if (host_realtime() != 0) {
+		fprintf(stderr, "%s: needs permission to use SCHED_FIFO\n", argv[0]);
+		return 1;
+	}
+
+	bench_waits = malloc(bench_rounds * sizeof(*bench_waits));
+
+	for (int i = 0; i < 3; i++) {
+		sem_init(&bench_go[i], 0, 0);
+	}
+
+	sem_init(&bench_held, 0, 0);
+	sem_init(&bench_done, 0, 0);
+
+	printf("high priority wait, low works %d us holding the mutex, medium works %d us\n",
+	       BENCH_LOW_WORK / 1000, BENCH_MEDIUM_WORK / 1000);
+
+	bench_run("without PI", 0);
+	bench_run("with PI", 1);
+
+	free(bench_waits);
+
+	return 0;
+}
@@ -0,0 +1,170 @@
+/**
+ * @file qspinlock.c
+ *
+ * @author awewsomegamer <awewsomegamer@gmail.com>
+ *
+ * @LICENSE
+ * Arctan-OS/Klib - Generic Kernel Functions and Data Structures
+ * Copyright (C) 2023-2026 awewsomegamer
+ *
+ * This file is part of Arctan-OS/Klib.
+ *
+ * Arctan-OS/Klib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * @DESCRIPTION
+*/
+/**
+ * Queued spinlock benchmark
+ *
+ * Runs 1 to 64 threads, each taking the lock in turn with a short
+ * critical section which writes BENCH_LINES shared cache lines, and
+ * compares ARC_QSpinlock with ARC_Spinlock. For each thread count the
+ * throughput of the whole run and the time each acquisition waited
+ * for the lock are reported. Every thread is given its own processor
+ * ID, as the queued spinlock keeps its queue nodes per processor.
+ *
+ * On a host with fewer processors than threads a waiter spins until
+ * the holder is scheduled again (see host/relax.h), so the tail
+ * latencies are mostly scheduler time slices there.
+ *
+ * Usage: qspinlock [max threads] [acquisitions per run]
+ * */
+#include "host/host.h"
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <lib/atomics.h>
+#include <lib/percpu.h>
+#include <lib/qspinlock.h>
+#include <lib/spinlock.h>
+
+#define BENCH_LINES 4
+
+static int bench_threads = 1;
+static long bench_iterations = 0;
+static int bench_use_queued = 1;
+
+static ARC_QSpinlock bench_qspinlock;
+static ARC_Spinlock bench_spinlock;
+static pthread_barrier_t bench_start;
+
+// Only written with the lock held
+static struct {
+	long value;
+} __attribute__((aligned(ARC_CACHE_LINE))) bench_lines[BENCH_LINES];
+
+static uint64_t *bench_samples = NULL;
+
+static void *bench_thread(void *arg) {
+	long id = (long)arg;
+	uint64_t *samples = &bench_samples[id * bench_iterations];
+
+	host_thread_init();
+	host_set_cpu(id);
+
+	pthread_barrier_wait(&bench_start);
+
+	for (long i = 0; i < bench_iterations; i++) {
+		uint64_t start = host_now();
+
+		if (bench_use_queued) {
+			qspinlock_lock(&bench_qspinlock);
+		} else {
+			spinlock_lock(&bench_spinlock);
+		}
+
+		samples[i] = host_now() - start;
+
+		for (int j = 0; j < BENCH_LINES; j++) {
+			bench_lines[j].value++;
+		}
+
+		if (bench_use_queued) {
+			qspinlock_unlock(&bench_qspinlock);
+		} else {
+			spinlock_unlock(&bench_spinlock);
+		}
+	}
+
+	return NULL;
+}
+
+static void bench_run(const char *lock, int threads, long acquisitions) {
+	pthread_t ids[ARC_PERCPU_MAX];
+
+	bench_threads = threads;
+	bench_iterations = acquisitions / threads;
+	bench_samples = malloc(threads * bench_iterations * sizeof(*bench_samples));
+
+	for (int j = 0; j < BENCH_LINES; j++) {
+		bench_lines[j].value = 0;
+	}
+
+	pthread_barrier_init(&bench_start, NULL, threads + 1);
+
+	for (long i = 0; i < threads; i++) {
+		pthread_create(&ids[i], NULL, bench_thread, (void *)i);
+	}
+
+	pthread_barrier_wait(&bench_start);
+	uint64_t start = host_now();
+
+	for (int i = 0; i < threads; i++) {
+		pthread_join(ids[i], NULL);
+	}
+
+	uint64_t elapsed = host_now() - start;
+	long total = threads * bench_iterations;
+
+	if (bench_lines[0].value != total) {
+		fprintf(stderr, "%s: lost updates, %ld of %ld\n", lock, bench_lines[0].value, total);
+		exit(1);
+	}
+
+	char name[64];
+	snprintf(name, sizeof(name), "%-9s %2d threads, %6.2f Macq/s, wait", lock, threads, total * 1000.0 / elapsed);
+	host_report(name, bench_samples, total);
+
+	pthread_barrier_destroy(&bench_start);
+	free(bench_samples);
+}
+
+int main(int argc, char **argv) {
+	int threads = argc > 1 ? atoi(argv[1]) : ARC_PERCPU_MAX;
+	long acquisitions = argc > 2 ? atol(argv[2]) : 640000;
+
+	if (threads < 1 || threads > ARC_PERCPU_MAX || acquisitions < threads) {
+		fprintf(stderr, "usage: %s [max threads (1-%d)] [acquisitions per run]\n", argv[0], ARC_PERCPU_MAX);
+		return 1;
+	}
+
+	host_init();
+	host_thread_init();
+	init_percpu(host_get_cpu, ARC_PERCPU_MAX);
+
+	init_static_qspinlock(&bench_qspinlock);
+	init_static_spinlock(&bench_spinlock);
+
+	for (int i = 1; i <= threads; i *= 2) {
+		bench_use_queued = 1;
+		bench_run("qspinlock", i, acquisitions);
+
+		bench_use_queued = 0;
+		bench_run("spinlock", i, acquisitions);
+	}
+
+	return 0;
+}
@@ -0,0 +1,290 @@
+/**
+ * @file ringbuffer.c
+ *
+ * @author awewsomegamer <awewsomegamer@gmail.com>
+ *
+ * @LICENSE
+ * Arctan-OS/Klib - Generic Kernel Functions and Data Structures
+ * Copyright (C) 2023-2026 awewsomegamer
+ *
+ * This file is part of Arctan-OS/Klib.
+ *
+ * Arctan-OS/Klib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * @DESCRIPTION
+*/
+/**
+ * Ringbuffer throughput benchmark
+ *
+ * First times a push and a pop of one object from a single thread for
+ * each mode, next to copying the object in and out with memcpy. Then a
+ * producer and a consumer thread move objects through the buffer, and
+ * the throughput is compared with copying the same data in and out of a
+ * buffer of the same size from one thread. A thread which finds the
+ * buffer full or empty yields. Last, 1 to BENCH_THREADS_MAX producers
+ * and as many consumers share an MPMC ring, and then a locked one.
+ *
+ * The copies are timed with both the C library's memcpy and klib's,
+ * which is what the ringbuffer copies objects with.
+ *
+ * Usage: ringbuffer [objects]
+ * */
+#include "host/host.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <lib/ringbuffer.h>
+
+#define BENCH_CAPACITY 1024
+#define BENCH_SINGLE   1000000
+#define BENCH_THREADS_MAX 8
+
+struct bench_object {
+	uint64_t value;
+	uint8_t payload[56];
+};
+
+// klib's memcpy, renamed when klib is built (see Makefile)
+void klib_memcpy(void *a, void *b, size_t size);
+
+static void bench_libc_memcpy(void *a, void *b, size_t size) {
+	memcpy(a, b, size);
+}
+
+static ARC_Ringbuffer *bench_ring = NULL;
+static long bench_objects = 10000000;
+static pthread_barrier_t bench_start;
+
+static const char *bench_mode_name(int mode) {
+	switch (mode) {
+		case ARC_RINGBUFFER_LOCKED: {
+			return "locked";
+		}
+
+		case ARC_RINGBUFFER_SPSC: {
+			return "spsc";
+		}
+
+		case ARC_RINGBUFFER_MPMC: {
+			return "mpmc";
+		}
+	}
+
+	return "?";
+}
+
+static ARC_Ringbuffer *bench_ring_init(int mode) {
+	void *base = calloc(BENCH_CAPACITY, sizeof(struct bench_object));
+	ARC_Ringbuffer *ring = init_ringbuffer_mode(base, BENCH_CAPACITY, sizeof(struct bench_object), mode);
+
+	if (ring == NULL) {
+		fprintf(stderr, "%s: cannot create ringbuffer\n", bench_mode_name(mode));
+		exit(1);
+	}
+
+	return ring;
+}
+
+static void bench_ring_uninit(ARC_Ringbuffer *ring) {
+	void *base = ring->base;
+
+	uninit_ringbuffer(ring);
+	free(base);
+}
+
+static void bench_single(int mode) {
+	ARC_Ringbuffer *ring = bench_ring_init(mode);
+	struct bench_object in = { 0 };
+	struct bench_object out = { 0 };
+
+	uint64_t start = host_now();
+
+	for (long i = 0; i < BENCH_SINGLE; i++) {
+		in.value = i;
+		ringbuffer_push(ring, &in);
+		ringbuffer_pop(ring, &out);
+	}
+
+	uint64_t elapsed = host_now() - start;
+
+	if (out.value != BENCH_SINGLE - 1) {
+		fprintf(stderr, "%s: popped %lu\n", bench_mode_name(mode), out.value);
+		exit(1);
+	}
+
+	printf("%-6s push+pop: %.1f ns\n", bench_mode_name(mode), (double)elapsed / BENCH_SINGLE);
+	bench_ring_uninit(ring);
+}
+
+static void bench_single_copy(const char *name, void (*copy)(void *, void *, size_t)) {
+	struct bench_object *buffer = calloc(BENCH_CAPACITY, sizeof(*buffer));
+	struct bench_object in = { 0 };
+	struct bench_object out = { 0 };
+
+	uint64_t start = host_now();
+
+	for (long i = 0; i < BENCH_SINGLE; i++) {
+		in.value = i;
+		copy(&buffer[i % BENCH_CAPACITY], &in, sizeof(in));
+		// Keep the compiler from dropping the copies
+		__asm__ volatile("" : : "r"(buffer) : "memory");
+		copy(&out, &buffer[i % BENCH_CAPACITY], sizeof(out));
+	}
+
+	uint64_t elapsed = host_now() - start;
+
+	printf("%-6s push+pop: %.1f ns (last %lu)\n", name, (double)elapsed / BENCH_SINGLE, out.value);
+	free(buffer);
+}
+
+static void *bench_producer(void *arg) {
+	long count = (long)arg;
+	struct bench_object obj = { 0 };
+
+	host_thread_init();
+	pthread_barrier_wait(&bench_start);
+
+	for (long i = 0; i < count; i++) {
+		obj.value = i;
+
+		while (ringbuffer_push(bench_ring, &obj) != 0) {
+			sched_yield();
+		}
+	}
+
+	return NULL;
+}
+
+static void *bench_consumer(void *arg) {
+	long count = (long)arg;
+	struct bench_object obj = { 0 };
+	uint64_t sum = 0;
+
+	host_thread_init();
+	pthread_barrier_wait(&bench_start);
+
+	for (long i = 0; i < count; i++) {
+		while (ringbuffer_pop(bench_ring, &obj) != 0) {
+			sched_yield();
+		}
+
+		sum += obj.value;
+	}
+
+	return (void *)sum;
+}
+
+// Each producer pushes objects / producers objects valued 0 and up,
+// consumers pop equal shares and the sum of the values is checked
+static uint64_t bench_pipe(int mode, int producers, int consumers) {
+	pthread_t ids[producers + consumers];
+	long per_producer = bench_objects / producers;
+	long total = per_producer * producers;
+	uint64_t sum = 0;
+
+	bench_ring = bench_ring_init(mode);
+	pthread_barrier_init(&bench_start, NULL, producers + consumers + 1);
+
+	for (int i = 0; i < producers; i++) {
+		pthread_create(&ids[i], NULL, bench_producer, (void *)per_producer);
+	}
+
+	for (int i = 0; i < consumers; i++) {
+		long share = total / consumers + (i < total % consumers);
+		pthread_create(&ids[producers + i], NULL, bench_consumer, (void *)share);
+	}
+
+	pthread_barrier_wait(&bench_start);
+	uint64_t start = host_now();
+
+	for (int i = 0; i < producers + consumers; i++) {
+		void *ret = NULL;
+		pthread_join(ids[i], &ret);
+		sum += (uint64_t)ret;
+	}
+
+	uint64_t elapsed = host_now() - start;
+
+	if (sum != (uint64_t)producers * per_producer * (per_producer - 1) / 2) {
+		fprintf(stderr, "%s: lost or duplicated objects\n", bench_mode_name(mode));
+		exit(1);
+	}
+
+	pthread_barrier_destroy(&bench_start);
+	bench_ring_uninit(bench_ring);
+
+	return elapsed;
+}
+
+static void bench_report(const char *name, long objects, uint64_t elapsed) {
+	printf("%s: %.2f M objects/s, %.0f MB/s\n", name, objects * 1000.0 / elapsed,
+	       objects * sizeof(struct bench_object) * 1000.0 / elapsed);
+}
+
+static void bench_pipe_copy(const char *name, void (*copy)(void *, void *, size_t)) {
+	struct bench_object *buffer = calloc(BENCH_CAPACITY, sizeof(*buffer));
+	struct bench_object *chunk = calloc(BENCH_CAPACITY, sizeof(*chunk));
+
+	uint64_t start = host_now();
+
+	for (long i = 0; i < bench_objects; i += BENCH_CAPACITY) {
+		copy(buffer, chunk, sizeof(*buffer) * BENCH_CAPACITY);
+		__asm__ volatile("" : : "r"(buffer) : "memory");
+		copy(chunk, buffer, sizeof(*buffer) * BENCH_CAPACITY);
+	}
+
+	bench_report(name, bench_objects, host_now() - start);
+
+	free(chunk);
+	free(buffer);
+}
+
+int main(int argc, char **argv) {
+	bench_objects = argc > 1 ? atol(argv[1]) : 10000000;
+
+	if (bench_objects < 1) {
+		fprintf(stderr, "usage: %s [objects]\n", argv[0]);
+		return 1;
+	}
+
+	host_init();
+	host_thread_init();
+
+	bench_single_copy("memcpy", bench_libc_memcpy);
+	bench_single_copy("klib", klib_memcpy);
+	bench_single(ARC_RINGBUFFER_LOCKED);
+	bench_single(ARC_RINGBUFFER_SPSC);
+	bench_single(ARC_RINGBUFFER_MPMC);
+
+	bench_pipe_copy("memcpy in and out", bench_libc_memcpy);
+	bench_pipe_copy("klib memcpy in and out", klib_memcpy);
+	bench_report("spsc, 1 producer 1 consumer", bench_objects, bench_pipe(ARC_RINGBUFFER_SPSC, 1, 1));
+	bench_report("locked, 1 producer 1 consumer", bench_objects, bench_pipe(ARC_RINGBUFFER_LOCKED, 1, 1));
+
+	int modes[] = { ARC_RINGBUFFER_MPMC, ARC_RINGBUFFER_LOCKED };
+
+	for (size_t i = 0; i < sizeof(modes) / sizeof(*modes); i++) {
+		for (int threads = 1; threads <= BENCH_THREADS_MAX; threads *= 2) {
+			char name[64];
+			snprintf(name, sizeof(name), "%s, %d producer and %d consumer threads", bench_mode_name(modes[i]), threads, threads);
+			bench_report(name, bench_objects, bench_pipe(modes[i], threads, threads));
+		}
+	}
+
+	return 0;
+}
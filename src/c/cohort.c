@@ -0,0 +1,125 @@
+/**
+ * @file cohort.c
+ *
+ * @author awewsomegamer <awewsomegamer@gmail.com>
+ *
+ * @LICENSE
+ * Arctan-OS/Klib - Generic Kernel Functions and Data Structures
+ * Copyright (C) 2023-2026 awewsomegamer
+ *
+ * This file is part of Arctan-OS/Klib.
+ *
+ * Arctan-OS/Klib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * @DESCRIPTION
+*/
+#include "lib/cohort.h"
+#include "lib/util.h"
+#include "mm/allocator.h"
+
+int init_cohort_lock(ARC_CohortLock **lock) {
+	if (lock == NULL) {
+		return 1;
+	}
+
+	*lock = (ARC_CohortLock *)alloc(sizeof(**lock));
+
+	if (*lock == NULL) {
+		return 1;
+	}
+
+	return init_static_cohort_lock(*lock);
+}
+
+int uninit_cohort_lock(ARC_CohortLock *lock) {
+	if (lock == NULL) {
+		return 1;
+	}
+
+	free(lock);
+
+	return 0;
+}
+
+int init_static_cohort_lock(ARC_CohortLock *lock) {
+	if (lock == NULL) {
+		return 1;
+	}
+
+	memset(lock, 0, sizeof(*lock));
+
+	return 0;
+}
+
+int cohort_lock(ARC_CohortLock *lock) {
+	if (lock == NULL) {
+		return 1;
+	}
+
+	uint32_t node = percpu_node();
+	struct ARC_Ticket ticket;
+
+	if (ticket_lock_node(&lock->nodes[node].lock, &ticket) != 0) {
+		return 1;
+	}
+
+	ticket_lock_yield(&ticket);
+
+	lock->nodes[node].ticket = ticket;
+
+	// The previous holder from this node may have passed the global
+	// lock on along with the local one
+	if (!lock->nodes[node].has_global) {
+		if (ticket_lock_node(&lock->global, &ticket) != 0) {
+			ticket_unlock(&lock->nodes[node].ticket);
+			return 1;
+		}
+
+		ticket_lock_yield(&ticket);
+
+		lock->global_ticket = ticket;
+		lock->nodes[node].has_global = 1;
+		lock->nodes[node].batch = 0;
+	}
+
+	lock->holder_node = node;
+
+	return 0;
+}
+
+int cohort_unlock(ARC_CohortLock *lock) {
+	if (lock == NULL) {
+		return 1;
+	}
+
+	uint32_t node = lock->holder_node;
+	struct ARC_TicketLock *local = &lock->nodes[node].lock;
+
+	uint32_t word = __atomic_load_n(&local->tickets.word, __ATOMIC_RELAXED);
+	uint16_t queued = (uint16_t)((word >> 16) - (word & 0xFFFF)) - 1;
+
+	if (queued > 0 && lock->nodes[node].batch < ARC_COHORT_BATCH) {
+		// Keep the global lock within the node
+		lock->nodes[node].batch++;
+		lock->local_handoffs++;
+	} else {
+		lock->nodes[node].has_global = 0;
+		lock->global_handoffs++;
+		ticket_unlock(&lock->global_ticket);
+	}
+
+	ticket_unlock(&lock->nodes[node].ticket);
+
+	return 0;
+}
@@ -0,0 +1,175 @@
+/**
+ * @file completion.c
+ *
+ * @author awewsomegamer <awewsomegamer@gmail.com>
+ *
+ * @LICENSE
+ * Arctan-OS/Klib - Generic Kernel Functions and Data Structures
+ * Copyright (C) 2023-2026 awewsomegamer
+ *
+ * This file is part of Arctan-OS/Klib.
+ *
+ * Arctan-OS/Klib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * @DESCRIPTION
+*/
+#include "lib/completion.h"
+#include "lib/atomics.h"
+#include "lib/park.h"
+#include "lib/schedhooks.h"
+#include "lib/util.h"
+#include "mm/allocator.h"
+
+#include <stddef.h>
+
+// Value of done after completion_complete_all
+#define COMPLETION_ALL UINT64_MAX
+
+static int completion_wait_slow(ARC_Completion *completion, uint64_t deadline) {
+	int r = 0;
+
+	__atomic_add_fetch(&completion->waiters, 1, __ATOMIC_SEQ_CST);
+
+	while (completion_trywait(completion) != 0) {
+		if (park_wait_timeout(&completion->done, 0, deadline) == -2) {
+			r = -2;
+			break;
+		}
+	}
+
+	__atomic_sub_fetch(&completion->waiters, 1, __ATOMIC_RELAXED);
+
+	return r;
+}
+
+int init_completion(ARC_Completion **completion) {
+	if (completion == NULL) {
+		return 1;
+	}
+
+	*completion = (ARC_Completion *)alloc(sizeof(**completion));
+
+	if (*completion == NULL) {
+		return 1;
+	}
+
+	memset(*completion, 0, sizeof(**completion));
+
+	return 0;
+}
+
+int uninit_completion(ARC_Completion *completion) {
+	free(completion);
+
+	return 0;
+}
+
+int init_static_completion(ARC_Completion *completion) {
+	if (completion == NULL) {
+		return 1;
+	}
+
+	memset(completion, 0, sizeof(*completion));
+
+	return 0;
+}
+
+int reinit_completion(ARC_Completion *completion) {
+	if (completion == NULL) {
+		return 1;
+	}
+
+	__atomic_store_n(&completion->done, 0, __ATOMIC_RELEASE);
+
+	return 0;
+}
+
+int completion_trywait(ARC_Completion *completion) {
+	if (completion == NULL) {
+		return 1;
+	}
+
+	uint64_t done = __atomic_load_n(&completion->done, __ATOMIC_SEQ_CST);
+
+	while (done > 0) {
+		if (done == COMPLETION_ALL) {
+			return 0;
+		}
+
+		if (__atomic_compare_exchange_n(&completion->done, &done, done - 1, 0, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+			return 0;
+		}
+	}
+
+	return -1;
+}
+
+int completion_wait(ARC_Completion *completion) {
+	if (completion == NULL) {
+		return 1;
+	}
+
+	if (completion_trywait(completion) == 0) {
+		return 0;
+	}
+
+	return completion_wait_slow(completion, 0);
+}
+
+int completion_wait_timeout(ARC_Completion *completion, uint64_t timeout) {
+	if (completion == NULL) {
+		return 1;
+	}
+
+	if (completion_trywait(completion) == 0) {
+		return 0;
+	}
+
+	return completion_wait_slow(completion, schedhooks_now() + timeout);
+}
+
+int completion_complete(ARC_Completion *completion) {
+	if (completion == NULL) {
+		return 1;
+	}
+
+	uint64_t done = __atomic_load_n(&completion->done, __ATOMIC_RELAXED);
+
+	do {
+		if (done == COMPLETION_ALL || done == COMPLETION_ALL - 1) {
+			// Already completed for everyone, or saturated
+			break;
+		}
+	} while (!__atomic_compare_exchange_n(&completion->done, &done, done + 1, 0, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED));
+
+	if (__atomic_load_n(&completion->waiters, __ATOMIC_SEQ_CST) > 0) {
+		park_wake(&completion->done, 1);
+	}
+
+	return 0;
+}
+
+int completion_complete_all(ARC_Completion *completion) {
+	if (completion == NULL) {
+		return 1;
+	}
+
+	__atomic_store_n(&completion->done, COMPLETION_ALL, __ATOMIC_SEQ_CST);
+
+	if (__atomic_load_n(&completion->waiters, __ATOMIC_SEQ_CST) > 0) {
+		park_wake(&completion->done, ARC_PARK_ALL);
+	}
+
+	return 0;
+}
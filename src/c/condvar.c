@@ -0,0 +1,137 @@
+/**
+ * @file condvar.c
+ *
+ * @author awewsomegamer <awewsomegamer@gmail.com>
+ *
+ * @LICENSE
+ * Arctan-OS/Klib - Generic Kernel Functions and Data Structures
+ * Copyright (C) 2023-2026 awewsomegamer
+ *
+ * This file is part of Arctan-OS/Klib.
+ *
+ * Arctan-OS/Klib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * @DESCRIPTION
+*/
+#include "lib/condvar.h"
+#include "lib/atomics.h"
+#include "lib/park.h"
+#include "lib/schedhooks.h"
+#include "lib/util.h"
+#include "mm/allocator.h"
+
+#include <stddef.h>
+
+static int condvar_wait_deadline(ARC_CondVar *cv, ARC_Mutex *mutex, uint64_t deadline) {
+	__atomic_store_n(&cv->mutex, mutex, __ATOMIC_RELAXED);
+
+	// NOTE: seq is read before the mutex is released, so a signal sent
+	//       after that changes it and keeps this thread from parking
+	uint64_t seq = __atomic_load_n(&cv->seq, __ATOMIC_ACQUIRE);
+
+	mutex_unlock(mutex);
+	int r = park_wait_timeout(&cv->seq, seq, deadline);
+
+	// The thread may have been moved onto the mutex, in which case there
+	// can be more sleepers behind it there that must be woken later
+	mutex_lock_contended(mutex);
+
+	// NOTE: A waiter moved onto the mutex by a broadcast can still time
+	//       out there. It was signalled all the same, which seq shows
+	if (r == -2 && __atomic_load_n(&cv->seq, __ATOMIC_ACQUIRE) != seq) {
+		return 0;
+	}
+
+	return r == -2 ? -2 : 0;
+}
+
+int init_condvar(ARC_CondVar **cv) {
+	if (cv == NULL) {
+		return 1;
+	}
+
+	*cv = (ARC_CondVar *)alloc(sizeof(**cv));
+
+	if (*cv == NULL) {
+		return 1;
+	}
+
+	memset(*cv, 0, sizeof(**cv));
+
+	return 0;
+}
+
+int uninit_condvar(ARC_CondVar *cv) {
+	free(cv);
+
+	return 0;
+}
+
+int init_static_condvar(ARC_CondVar *cv) {
+	if (cv == NULL) {
+		return 1;
+	}
+
+	memset(cv, 0, sizeof(*cv));
+
+	return 0;
+}
+
+int condvar_wait(ARC_CondVar *cv, ARC_Mutex *mutex) {
+	if (cv == NULL || mutex == NULL) {
+		return 1;
+	}
+
+	return condvar_wait_deadline(cv, mutex, 0);
+}
+
+int condvar_wait_timeout(ARC_CondVar *cv, ARC_Mutex *mutex, uint64_t timeout) {
+	if (cv == NULL || mutex == NULL) {
+		return 1;
+	}
+
+	return condvar_wait_deadline(cv, mutex, schedhooks_now() + timeout);
+}
+
+int condvar_signal(ARC_CondVar *cv) {
+	if (cv == NULL) {
+		return 1;
+	}
+
+	__atomic_add_fetch(&cv->seq, 1, __ATOMIC_RELEASE);
+	park_wake(&cv->seq, 1);
+
+	return 0;
+}
+
+int condvar_broadcast(ARC_CondVar *cv) {
+	if (cv == NULL) {
+		return 1;
+	}
+
+	__atomic_add_fetch(&cv->seq, 1, __ATOMIC_RELEASE);
+
+	ARC_Mutex *mutex = __atomic_load_n(&cv->mutex, __ATOMIC_RELAXED);
+
+	if (mutex == NULL) {
+		park_wake(&cv->seq, ARC_PARK_ALL);
+		return 0;
+	}
+
+	// Wake one waiter, which marks the mutex contended when it takes it,
+	// and move the rest onto the mutex to be woken by its unlocks
+	park_requeue(&cv->seq, mutex, 1, ARC_PARK_ALL);
+
+	return 0;
+}
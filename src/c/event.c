@@ -24,47 +24,336 @@
  *
  * @DESCRIPTION
 */
+#include "global.h"
 #include "lib/event.h"
-#include "util.h"
+#include "lib/atomics.h"
+#include "lib/park.h"
+#include "lib/percpu.h"
+#include "lib/util.h"
+#include "mm/allocator.h"
 
-ARC_EventElement terminator = { 0 };
+#include <stdbool.h>
+#include <stddef.h>
+
+#define EVENT_REMOVED 1
+
+// Events with a deferred trigger queued on a processor, newest first
+static struct {
+	ARC_Event *head;
+} __attribute__((aligned(ARC_CACHE_LINE))) event_deferred[ARC_PERCPU_MAX] = { 0 };
+
+static ARC_EventKickFn event_kick = NULL;
+
+static inline ARC_EventElement *event_ptr(ARC_EventElement *elem) {
+	return (ARC_EventElement *)((uintptr_t)elem & ~(uintptr_t)EVENT_REMOVED);
+}
+
+static inline int event_removed(ARC_EventElement *elem) {
+	return ((uintptr_t)elem & EVENT_REMOVED) != 0;
+}
+
+static inline uint64_t event_interest(ARC_EventElement *elem) {
+	return elem->mask == 0 ? ARC_EVENT_ALL : elem->mask;
+}
+
+/**
+ * Find the link pointing to elem (NULL for the end of the list).
+ *
+ * If insert is set, stop instead at the first element with a lower
+ * priority than elem, which is where elem is to be linked in. The element
+ * the link points to is returned in *found. Elements being unregistered
+ * are unlinked on the way. The link is only valid until the list
+ * changes, callers CAS on it and search again if that fails.
+ * */
+static ARC_EventElement **event_search(ARC_Event *event, ARC_EventElement *elem, bool insert, ARC_EventElement **found) {
+	retry:;
+	ARC_EventElement **prev = &event->head;
+	ARC_EventElement *current = __atomic_load_n(prev, __ATOMIC_ACQUIRE);
+
+	for (;;) {
+		// The element holding prev was removed under us
+		if (event_removed(current)) {
+			goto retry;
+		}
+
+		if (current == NULL) {
+			*found = current;
+			return prev;
+		}
+
+		ARC_EventElement *next = __atomic_load_n(&current->next, __ATOMIC_ACQUIRE);
+
+		if (event_removed(next)) {
+			if (!__atomic_compare_exchange_n(prev, &current, event_ptr(next), 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+				goto retry;
+			}
+
+			current = event_ptr(next);
+			continue;
+		}
+
+		if (current == elem || (insert && current->priority < elem->priority)) {
+			*found = current;
+			return prev;
+		}
+
+		prev = &current->next;
+		current = next;
+	}
+}
+
+static inline uint64_t event_read_lock(ARC_Event *event) {
+	uint64_t idx = __atomic_load_n(&event->epoch, __ATOMIC_ACQUIRE) & 1;
+	__atomic_add_fetch(&event->active[idx], 1, __ATOMIC_SEQ_CST);
+
+	return idx;
+}
+
+static inline void event_read_unlock(ARC_Event *event, uint64_t idx) {
+	if (__atomic_sub_fetch(&event->active[idx], 1, __ATOMIC_SEQ_CST) == 0
+	    && __atomic_load_n(&event->syncing, __ATOMIC_SEQ_CST)) {
+		park_wake(&event->active[idx], ARC_PARK_ALL);
+	}
+}
+
+// Wait for every trigger which may have seen an element that has
+// since been unlinked
+static void event_synchronize(ARC_Event *event) {
+	mutex_lock(&event->sync);
+	__atomic_store_n(&event->syncing, 1, __ATOMIC_SEQ_CST);
+
+	// NOTE: The epoch is flipped twice, as a trigger may have read the
+	//       epoch before the first flip and only counted itself after it
+	for (int i = 0; i < 2; i++) {
+		uint64_t idx = __atomic_fetch_add(&event->epoch, 1, __ATOMIC_SEQ_CST) & 1;
+		uint64_t active = 0;
+
+		while ((active = __atomic_load_n(&event->active[idx], __ATOMIC_SEQ_CST)) != 0) {
+			park_wait(&event->active[idx], active);
+		}
+	}
+
+	__atomic_store_n(&event->syncing, 0, __ATOMIC_SEQ_CST);
+	mutex_unlock(&event->sync);
+}
+
+static uint64_t event_gather_interest(ARC_Event *event) {
+	uint64_t interest = 0;
+	uint64_t idx = event_read_lock(event);
+
+	ARC_EventElement *current = __atomic_load_n(&event->head, __ATOMIC_ACQUIRE);
+	while (current != NULL) {
+		ARC_EventElement *next = __atomic_load_n(&current->next, __ATOMIC_ACQUIRE);
+
+		if (!event_removed(next)) {
+			interest |= event_interest(current);
+		}
+
+		current = event_ptr(next);
+	}
+
+	event_read_unlock(event, idx);
+
+	return interest;
+}
+
+static void event_update_interest(ARC_Event *event) {
+	__atomic_store_n(&event->interest, event_gather_interest(event), __ATOMIC_RELEASE);
+	__atomic_or_fetch(&event->interest, event_gather_interest(event), __ATOMIC_RELEASE);
+}
+
+int init_event(ARC_Event **event) {
+	if (event == NULL) {
+		return 1;
+	}
+
+	*event = (ARC_Event *)alloc(sizeof(**event));
+
+	if (*event == NULL) {
+		return 1;
+	}
+
+	return init_static_event(*event);
+}
+
+int uninit_event(ARC_Event *event) {
+	free(event);
+
+	return 0;
+}
+
+int init_static_event(ARC_Event *event) {
+	if (event == NULL) {
+		return 1;
+	}
+
+	memset(event, 0, sizeof(*event));
+
+	return 0;
+}
 
 int event_register(ARC_Event *event, ARC_EventElement *elem) {
-        if (event == NULL || elem == NULL) {
+	if (event == NULL || elem == NULL) {
+		return 1;
+	}
+
+	// NOTE: The search holds the read side like a trigger, otherwise an
+	//       element unregistered under it could be freed while its link
+	//       is still being read or swapped
+	uint64_t idx = event_read_lock(event);
+
+	for (;;) {
+		ARC_EventElement *next = NULL;
+		ARC_EventElement **link = event_search(event, elem, 1, &next);
+
+		__atomic_store_n(&elem->next, next, __ATOMIC_RELAXED);
+
+		if (__atomic_compare_exchange_n(link, &next, elem, 0, __ATOMIC_RELEASE, __ATOMIC_RELAXED)) {
+			break;
+		}
+	}
+
+	event_read_unlock(event, idx);
+
+	__atomic_or_fetch(&event->interest, event_interest(elem), __ATOMIC_RELEASE);
+
+	return 0;
+}
+
+int event_unregister(ARC_Event *event, ARC_EventElement *elem) {
+	if (event == NULL || elem == NULL) {
 		return 1;
 	}
 
-	// Save interrupt flag
+	ARC_EventElement *found = NULL;
+	uint64_t idx = event_read_lock(event);
+	event_search(event, elem, 0, &found);
 
-	ARC_DISABLE_INTERRUPT;
-	ARC_EventElement *_elem = elem;
-	ARC_EventElement *t = NULL;
-	ARC_ATOMIC_XCHG(&event->last, &_elem, &t);
-	if (t != NULL) {
-		t->next = elem;
-	} else {
-		event->current = elem;
+	if (found != elem) {
+		event_read_unlock(event, idx);
+		return -1;
 	}
 
-	// Restore interrupt flag
+	// Mark the element, which stops triggers from calling it and
+	// registrations from linking behind it
+	ARC_EventElement *next = __atomic_load_n(&elem->next, __ATOMIC_RELAXED);
+	do {
+		if (event_removed(next)) {
+			event_read_unlock(event, idx);
+			return -1;
+		}
+	} while (!__atomic_compare_exchange_n(&elem->next, &next, (ARC_EventElement *)((uintptr_t)next | EVENT_REMOVED), 0, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED));
+
+	// Walk the whole list, unlinking it. The read side is dropped
+	// before waiting, as the wait would otherwise include this walk
+	event_search(event, NULL, 0, &found);
+	event_read_unlock(event, idx);
+	event_synchronize(event);
+
+	// NOTE: The interest is gathered again after it is stored, so that a
+	//       handler registered during the first pass cannot be dropped
+	event_update_interest(event);
 
-        return 0;
+	return 0;
 }
 
 int event_trigger(ARC_Event *event, void *args) {
-	event_register(event, &terminator);
+	return event_trigger_mask(event, args, ARC_EVENT_ALL);
+}
+
+int event_trigger_mask(ARC_Event *event, void *args, uint64_t mask) {
+	if (event == NULL) {
+		return 1;
+	}
+
+	if ((__atomic_load_n(&event->interest, __ATOMIC_ACQUIRE) & mask) == 0) {
+		return 0;
+	}
+
+	uint64_t idx = event_read_lock(event);
 
-	while (event->current != NULL && event->current != &terminator) {
-		void (*func)(void *args) = event->current->handler;
+	ARC_EventElement *current = __atomic_load_n(&event->head, __ATOMIC_ACQUIRE);
+	while (current != NULL) {
+		ARC_EventElement *next = __atomic_load_n(&current->next, __ATOMIC_ACQUIRE);
 
-		if (func != NULL) {
-			func(args);
+		if (!event_removed(next) && current->handler != NULL && (event_interest(current) & mask) != 0) {
+			current->handler(args);
 		}
+
+		current = event_ptr(next);
+	}
+
+	event_read_unlock(event, idx);
+
+	return 0;
+}
+
+int event_trigger_deferred(ARC_Event *event, void *args) {
+	if (event == NULL) {
+		return 1;
 	}
 
-	if (event->current == &terminator) {
-		event->current = event->current->next;
+	// Only the trigger which sets pending queues the event, the others
+	// are merged into it
+	if (__atomic_exchange_n(&event->pending, 1, __ATOMIC_ACQUIRE) != 0) {
+		return -1;
 	}
 
-        return 0;
+	event->deferred_args = args;
+
+	uint32_t cpu = percpu_id();
+	ARC_Event *head = __atomic_load_n(&event_deferred[cpu].head, __ATOMIC_RELAXED);
+
+	do {
+		event->deferred_next = head;
+	} while (!__atomic_compare_exchange_n(&event_deferred[cpu].head, &head, event, 1, __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+
+	if (head == NULL && event_kick != NULL) {
+		event_kick(cpu);
+	}
+
+	return 0;
+}
+
+int event_drain_deferred() {
+	uint32_t cpu = percpu_id();
+	ARC_Event *list = __atomic_exchange_n(&event_deferred[cpu].head, NULL, __ATOMIC_ACQUIRE);
+
+	// Put the batch back into the order it was queued in
+	ARC_Event *ordered = NULL;
+	while (list != NULL) {
+		ARC_Event *next = list->deferred_next;
+		list->deferred_next = ordered;
+		ordered = list;
+		list = next;
+	}
+
+	int count = 0;
+
+	while (ordered != NULL) {
+		ARC_Event *event = ordered;
+		ordered = event->deferred_next;
+
+		// Triggers from now on (including ones made by the handlers)
+		// queue the event again
+		void *args = event->deferred_args;
+		__atomic_store_n(&event->pending, 0, __ATOMIC_RELEASE);
+
+		event_trigger(event, args);
+		count++;
+	}
+
+	return count;
+}
+
+int init_event_deferred(ARC_EventKickFn kick) {
+	if (kick == NULL) {
+		return 1;
+	}
+
+	event_kick = kick;
+
+	ARC_DEBUG(INFO, "Initialized deferred event dispatch\n");
+
+	return 0;
 }
@@ -39,10 +39,16 @@
 
 #define ARC_MEM_BARRIER   __asm__("" ::: "memory");
 
+/// Size of a cache line, used to keep contended words apart
+#define ARC_CACHE_LINE 64
+
 #ifdef ARC_TARGET_ARCH_X86_64
 #define ARC_ATOMIC_LFENCE __asm__("lfence" :::);
 #define ARC_ATOMIC_SFENCE __asm__("sfence" :::);
 #define ARC_ATOMIC_MFENCE __asm__("mfence" :::);
+#define ARC_CPU_RELAX     __asm__("pause" ::: "memory");
+#else
+#define ARC_CPU_RELAX     ARC_MEM_BARRIER
 #endif
 
 #endif
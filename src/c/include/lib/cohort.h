@@ -0,0 +1,82 @@
+/**
+ * @file cohort.h
+ *
+ * @author awewsomegamer <awewsomegamer@gmail.com>
+ *
+ * @LICENSE
+ * Arctan-OS/Klib - Generic Kernel Functions and Data Structures
+ * Copyright (C) 2023-2026 awewsomegamer
+ *
+ * This file is part of Arctan-OS/Klib.
+ *
+ * Arctan-OS/Klib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * @DESCRIPTION
+*/
+#ifndef ARC_LIB_COHORT_H
+#define ARC_LIB_COHORT_H
+
+#include <stdint.h>
+
+#include "lib/atomics.h"
+#include "lib/percpu.h"
+#include "lib/ticket.h"
+
+/// Times the lock may pass between threads of one node before the node gives it up
+#ifndef ARC_COHORT_BATCH
+#define ARC_COHORT_BATCH 64
+#endif
+
+/**
+ * Cohort lock
+ *
+ * A lock for machines with several memory nodes. Threads first queue
+ * on a ticket lock local to their node (see percpu_node()). The first
+ * thread of a node to get through then queues on the global ticket lock
+ * on behalf of the whole node. While threads of that node are waiting,
+ * the lock is passed between them without touching the global lock,
+ * up to ARC_COHORT_BATCH times in a row, after which the global lock is
+ * released so that other nodes get their turn.
+ *
+ * NOTE: Like ARC_RWSpinlock, this lock does not touch the interrupt
+ *       flag.
+ * */
+typedef struct ARC_CohortLock {
+        struct {
+                struct ARC_TicketLock lock;
+                /// Ticket of the node's lock holder
+                struct ARC_Ticket ticket;
+                /// Set while the node owns the global lock
+                uint32_t has_global;
+                /// Consecutive handoffs within the node
+                uint32_t batch;
+        } __attribute__((aligned(ARC_CACHE_LINE))) nodes[ARC_PERCPU_NODES_MAX];
+        struct ARC_TicketLock global;
+        /// Ticket of the node owning the global lock
+        struct ARC_Ticket global_ticket;
+        /// Node of the current holder
+        uint32_t holder_node;
+        /// Times the lock moved from one node to another (or was released)
+        uint64_t global_handoffs;
+        /// Times the lock was passed on within a node
+        uint64_t local_handoffs;
+} ARC_CohortLock;
+
+int init_cohort_lock(ARC_CohortLock **lock);
+int uninit_cohort_lock(ARC_CohortLock *lock);
+int init_static_cohort_lock(ARC_CohortLock *lock);
+int cohort_lock(ARC_CohortLock *lock);
+int cohort_unlock(ARC_CohortLock *lock);
+
+#endif
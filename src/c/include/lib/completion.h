@@ -0,0 +1,66 @@
+/**
+ * @file completion.h
+ *
+ * @author awewsomegamer <awewsomegamer@gmail.com>
+ *
+ * @LICENSE
+ * Arctan-OS/Klib - Generic Kernel Functions and Data Structures
+ * Copyright (C) 2023-2026 awewsomegamer
+ *
+ * This file is part of Arctan-OS/Klib.
+ *
+ * Arctan-OS/Klib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * @DESCRIPTION
+*/
+#ifndef ARC_LIB_COMPLETION_H
+#define ARC_LIB_COMPLETION_H
+
+#include <stdint.h>
+
+/**
+ * Completion
+ *
+ * Lets threads sleep until some piece of work (e.g. an I/O request)
+ * is done. Each completion_complete lets one waiter through, while
+ * completion_complete_all lets every current and future waiter
+ * through until the completion is reinitialized.
+ * */
+typedef struct ARC_Completion {
+        uint64_t done;
+        /// Number of threads in the sleeping path of completion_wait
+        uint64_t waiters;
+} ARC_Completion;
+
+int init_completion(ARC_Completion **completion);
+int uninit_completion(ARC_Completion *completion);
+int init_static_completion(ARC_Completion *completion);
+/// Reset a completion so it can be waited on again
+int reinit_completion(ARC_Completion *completion);
+
+int completion_wait(ARC_Completion *completion);
+/**
+ * Wait, giving up after the given time.
+ *
+ * @param uint64_t timeout - Time to wait, in the units of schedhooks_now.
+ * @return 0 if completed, -2 on timeout.
+ * */
+int completion_wait_timeout(ARC_Completion *completion, uint64_t timeout);
+/// Returns 0 if the completion was consumed, -1 if it is not done
+int completion_trywait(ARC_Completion *completion);
+
+int completion_complete(ARC_Completion *completion);
+int completion_complete_all(ARC_Completion *completion);
+
+#endif
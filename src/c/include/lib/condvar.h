@@ -0,0 +1,75 @@
+/**
+ * @file condvar.h
+ *
+ * @author awewsomegamer <awewsomegamer@gmail.com>
+ *
+ * @LICENSE
+ * Arctan-OS/Klib - Generic Kernel Functions and Data Structures
+ * Copyright (C) 2023-2026 awewsomegamer
+ *
+ * This file is part of Arctan-OS/Klib.
+ *
+ * Arctan-OS/Klib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * @DESCRIPTION
+*/
+#ifndef ARC_LIB_CONDVAR_H
+#define ARC_LIB_CONDVAR_H
+
+#include <stdint.h>
+
+#include "lib/mutex.h"
+
+/**
+ * Condition variable
+ *
+ * Waits atomically release an ARC_Mutex and take it again before
+ * returning. A broadcast wakes one waiter and moves the rest onto the
+ * mutex, where they are woken one at a time as it is released, rather
+ * than all at once to fight over it.
+ *
+ * NOTE: The state waited for must only be changed with the mutex held,
+ *       otherwise wakeups can be lost.
+ * */
+typedef struct ARC_CondVar {
+        /// Bumped on every signal and broadcast
+        uint64_t seq;
+        /// The mutex waiters last waited with
+        ARC_Mutex *mutex;
+} ARC_CondVar;
+
+int init_condvar(ARC_CondVar **cv);
+int uninit_condvar(ARC_CondVar *cv);
+int init_static_condvar(ARC_CondVar *cv);
+
+/**
+ * Release the mutex and sleep until signalled.
+ *
+ * The mutex must be held, and is held again when this returns. Spurious
+ * wakeups are possible, the caller must recheck its condition.
+ * */
+int condvar_wait(ARC_CondVar *cv, ARC_Mutex *mutex);
+/**
+ * Like condvar_wait, giving up after the given time.
+ *
+ * @param uint64_t timeout - Time to wait, in the units of schedhooks_now.
+ * @return 0 if signalled, -2 on timeout.
+ * */
+int condvar_wait_timeout(ARC_CondVar *cv, ARC_Mutex *mutex, uint64_t timeout);
+/// Wake one waiter
+int condvar_signal(ARC_CondVar *cv);
+/// Wake all waiters
+int condvar_broadcast(ARC_CondVar *cv);
+
+#endif
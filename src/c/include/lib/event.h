@@ -27,17 +27,129 @@
 #ifndef ARC_LIB_EVENT_H
 #define ARC_LIB_EVENT_H
 
+#include <stdint.h>
+
+#include "lib/mutex.h"
+
+/**
+ * Handler registered with an event
+ *
+ * Supplied by the caller and linked into the event directly, it must
+ * stay valid until event_unregister returns.
+ * */
 typedef struct ARC_EventElement {
         void (*handler)(void *args);
+        /// Handlers with higher priorities are called first
+        int priority;
+        /// Trigger bits the handler is interested in, 0 for every trigger
+        uint64_t mask;
+        /// Next handler, bit 0 is set once the element is being unregistered
         struct ARC_EventElement *next;
 } ARC_EventElement;
 
+/// Trigger mask matching every handler
+#define ARC_EVENT_ALL UINT64_MAX
+
+/**
+ * Event
+ *
+ * A lock-free list of handlers, ordered by priority. Registering, unregistering and
+ * triggering never take a lock, so any number of processors may trigger
+ * the same event at once. Triggers mark themselves as readers of the
+ * current epoch, which lets event_unregister wait for every trigger that
+ * could still see a removed handler before handing it back.
+ * */
 typedef struct ARC_Event {
-        struct ARC_EventElement *current;
-        struct ARC_EventElement *last;
+        struct ARC_EventElement *head;
+        /// Union of the masks of the registered handlers
+        uint64_t interest;
+        /// Bit 0 selects the reader count new triggers use
+        uint64_t epoch;
+        /// Triggers in progress, per epoch
+        uint64_t active[2];
+        /// Set while event_unregister waits for triggers to finish
+        uint64_t syncing;
+        /// Serializes waiting for triggers
+        ARC_Mutex sync;
+        /// Set while a deferred trigger is queued
+        uint64_t pending;
+        /// Arguments of the queued deferred trigger
+        void *deferred_args;
+        /// Next event in the same deferred queue
+        struct ARC_Event *deferred_next;
 } ARC_Event;
 
+/// Called when a processor's deferred queue becomes non-empty
+typedef void (*ARC_EventKickFn)(uint32_t cpu);
+
+int init_event(ARC_Event **event);
+int uninit_event(ARC_Event *event);
+int init_static_event(ARC_Event *event);
+
+/**
+ * Add a handler.
+ *
+ * The handler is placed after every handler of the same or a higher
+ * priority. Its priority and mask must be set beforehand and not be
+ * changed while it is registered.
+ * */
 int event_register(ARC_Event *event, ARC_EventElement *elem);
+
+/**
+ * Remove a handler.
+ *
+ * Returns once no trigger can still be calling or looking at the handler,
+ * so it may sleep and must not be called from a handler of the same event.
+ *
+ * @return 0 upon success, 1 upon bad arguments, -1 if the handler is not
+ * registered with the event.
+ * */
+int event_unregister(ARC_Event *event, ARC_EventElement *elem);
+
+/// Call every registered handler with the given arguments
 int event_trigger(ARC_Event *event, void *args);
 
+/**
+ * Call the handlers interested in a trigger.
+ *
+ * Only handlers whose mask shares a bit with the given mask (or whose
+ * mask is 0) are called. If no registered handler is interested the
+ * call returns without looking at the list.
+ * */
+int event_trigger_mask(ARC_Event *event, void *args, uint64_t mask);
+
+/**
+ * Queue a trigger to be dispatched later.
+ *
+ * The event is put on the calling processor's deferred queue, and its
+ * handlers are called from the next event_drain_deferred on that
+ * processor. Further deferred triggers of the event before then are
+ * merged into the queued one, whose arguments are the ones used. Safe
+ * to call from interrupt context. The event must not be freed while
+ * queued.
+ *
+ * @return 0 if the trigger was queued, -1 if it was merged into an
+ * already queued one, 1 upon bad arguments.
+ * */
+int event_trigger_deferred(ARC_Event *event, void *args);
+
+/**
+ * Dispatch the calling processor's deferred triggers.
+ *
+ * Meant to be called from a worker thread or softirq-like context,
+ * handlers run in the caller. Triggers are dispatched in the order
+ * they were queued.
+ *
+ * @return the number of events dispatched.
+ * */
+int event_drain_deferred();
+
+/**
+ * Set the function used to notify a processor of deferred work.
+ *
+ * Called when a processor's queue goes from empty to non-empty, e.g. to
+ * raise a softirq or wake the processor's worker.
+ * */
+int init_event_deferred(ARC_EventKickFn kick);
+
 #endif
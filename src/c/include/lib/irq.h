@@ -0,0 +1,81 @@
+/**
+ * @file irq.h
+ *
+ * @author awewsomegamer <awewsomegamer@gmail.com>
+ *
+ * @LICENSE
+ * Arctan-OS/Klib - Generic Kernel Functions and Data Structures
+ * Copyright (C) 2023-2026 awewsomegamer
+ *
+ * This file is part of Arctan-OS/Klib.
+ *
+ * Arctan-OS/Klib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * @DESCRIPTION
+*/
+#ifndef ARC_LIB_IRQ_H
+#define ARC_LIB_IRQ_H
+
+#include <stdint.h>
+
+/// Interrupt state saved by irq_save
+typedef uint64_t ARC_IRQFlags;
+
+/**
+ * Called to deliver an interrupt deferred by the lazy mode on cpu.
+ *
+ * Normally called on cpu itself. If a caller of irq_save was migrated
+ * while raising the count, it may be called from another processor, and
+ * must then make cpu deliver the interrupt (e.g. by sending it an IPI).
+ * */
+typedef void (*ARC_IRQReplayFn)(uint32_t cpu);
+
+/**
+ * Disable interrupts, returning the previous state.
+ *
+ * By default this masks interrupts in hardware. In the lazy mode only
+ * a per-CPU "soft disabled" count is raised, and the hardware is masked
+ * only if an interrupt actually arrives (see irq_lazy_intercept).
+ * */
+ARC_IRQFlags irq_save();
+
+/**
+ * Restore the interrupt state returned by irq_save.
+ *
+ * In the lazy mode, if an interrupt was deferred and this re-enables
+ * interrupts, the replay function is called to deliver it.
+ * */
+void irq_restore(ARC_IRQFlags flags);
+
+/**
+ * Switch to lazy interrupt masking.
+ *
+ * Should be called once, before other processors are started and with
+ * no interrupt state saved.
+ * */
+int init_lazy_irq(ARC_IRQReplayFn replay);
+
+/**
+ * Check whether an interrupt has to be deferred.
+ *
+ * Must be called by the kernel's interrupt entry path. If the calling
+ * processor is soft disabled, the interrupt is recorded as pending and
+ * 1 is returned: the kernel must then return from the interrupt with
+ * interrupts masked in hardware and keep whatever it needs to deliver
+ * it later from the replay function. Returns 0 if the interrupt should
+ * be handled now.
+ * */
+int irq_lazy_intercept();
+
+#endif
@@ -0,0 +1,118 @@
+/**
+ * @file lockstat.h
+ *
+ * @author awewsomegamer <awewsomegamer@gmail.com>
+ *
+ * @LICENSE
+ * Arctan-OS/Klib - Generic Kernel Functions and Data Structures
+ * Copyright (C) 2023-2026 awewsomegamer
+ *
+ * This file is part of Arctan-OS/Klib.
+ *
+ * Arctan-OS/Klib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * @DESCRIPTION
+*/
+#ifndef ARC_LIB_LOCKSTAT_H
+#define ARC_LIB_LOCKSTAT_H
+
+/**
+ * Lock statistics
+ *
+ * When klib is built with ARC_LOCKSTAT defined, ARC_Spinlock, ARC_Mutex,
+ * ARC_ListMutex and ARC_TicketLock record, per lock class, how often
+ * they are taken, how often callers had to wait, and histograms of wait
+ * and hold times in cycles. Locks count towards the default class of
+ * their type unless given a class with ARC_LOCKSTAT_SET_CLASS.
+ *
+ * Without ARC_LOCKSTAT the hooks expand to nothing and the locks carry
+ * no extra state.
+ * */
+
+#ifdef ARC_LOCKSTAT
+
+#include <stdint.h>
+
+#include "userspace/thread.h"
+
+/// Number of histogram buckets, bucket i counts times in [2^(i-1), 2^i)
+#ifndef ARC_LOCKSTAT_BUCKETS
+#define ARC_LOCKSTAT_BUCKETS 32
+#endif
+
+typedef struct ARC_LockClass {
+        const char *name;
+        /// Next registered class
+        struct ARC_LockClass *next;
+        uint32_t registered;
+        uint64_t acquisitions;
+        /// Acquisitions which had to wait for another holder
+        uint64_t contentions;
+        uint64_t wait[ARC_LOCKSTAT_BUCKETS];
+        uint64_t hold[ARC_LOCKSTAT_BUCKETS];
+        /// Longest hold time seen and the thread which held the lock
+        uint64_t max_hold;
+        ARC_Thread *max_holder;
+} ARC_LockClass;
+
+/// Per-lock state, embedded in each lock as the lockstat member
+typedef struct ARC_LockStat {
+        /// Class to count towards, NULL for the default of the lock type
+        ARC_LockClass *class;
+        /// Time at which the current holder got the lock
+        uint64_t acquired;
+} __attribute__((packed)) ARC_LockStat;
+
+/// Define a lock class
+#define ARC_LOCKSTAT_CLASS(_var, _name) ARC_LockClass _var = { .name = _name }
+
+extern ARC_LockClass lockstat_spinlock_class;
+extern ARC_LockClass lockstat_mutex_class;
+extern ARC_LockClass lockstat_list_mutex_class;
+extern ARC_LockClass lockstat_ticket_class;
+
+/// Current cycle count
+uint64_t lockstat_now();
+
+void lockstat_acquired(ARC_LockStat *stat, ARC_LockClass *def, uint64_t start, int contended);
+void lockstat_released(ARC_LockStat *stat, ARC_LockClass *def);
+
+/**
+ * Get the registered lock classes.
+ *
+ * Classes are registered when a lock of the class is first taken, and
+ * are linked through ARC_LockClass.next. Counters are updated without
+ * locking, so a class read while its locks are in use is only roughly
+ * consistent.
+ * */
+ARC_LockClass *lockstat_classes();
+
+/// Zero the counters of a class
+int lockstat_reset(ARC_LockClass *class);
+
+#define ARC_LOCKSTAT_START(_var) uint64_t _var = lockstat_now()
+#define ARC_LOCKSTAT_ACQUIRED(_stat, _def, _start, _contended) lockstat_acquired(_stat, _def, _start, _contended)
+#define ARC_LOCKSTAT_RELEASED(_stat, _def) lockstat_released(_stat, _def)
+#define ARC_LOCKSTAT_SET_CLASS(_stat, _class) ((_stat)->class = (_class))
+
+#else
+
+#define ARC_LOCKSTAT_START(_var)
+#define ARC_LOCKSTAT_ACQUIRED(_stat, _def, _start, _contended)
+#define ARC_LOCKSTAT_RELEASED(_stat, _def)
+#define ARC_LOCKSTAT_SET_CLASS(_stat, _class)
+
+#endif
+
+#endif
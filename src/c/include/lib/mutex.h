@@ -27,31 +27,64 @@
 #ifndef ARC_LIB_MUTEX_H
 #define ARC_LIB_MUTEX_H
 
+#include "lib/lockstat.h"
 #include "userspace/thread.h"
 #include <stdint.h>
 
+/// Number of times mutex_lock polls a running owner before sleeping
+#ifndef ARC_MUTEX_SPIN_MAX
+#define ARC_MUTEX_SPIN_MAX 1024
+#endif
+
 // NOTE: This struct being packed allows for the lock
 //       to be placed prior to the thread to wake letting
 //       the lock be easily accessed
 typedef struct ARC_Mutex {
         uint64_t lock;
         ARC_Thread *wake;
+#ifdef ARC_LOCKSTAT
+        ARC_LockStat lockstat;
+#endif
 } __attribute__((packed)) ARC_Mutex;
 
 typedef struct ARC_ListMutexElement {
         struct ARC_ListMutexElement *next;
         ARC_Thread *wake;
+        /// Set by the previous owner when it hands the mutex over
+        uint64_t granted;
 } ARC_ListMutexElement;
 
+/**
+ * Queued sleeping mutex
+ *
+ * Lockers queue up in FIFO order using caller provided elements and
+ * sleep until the previous owner hands the mutex over to them directly.
+ * */
 typedef struct ARC_ListMutex {
         ARC_ListMutexElement *current;
         ARC_ListMutexElement *last;
+#ifdef ARC_LOCKSTAT
+        ARC_LockStat lockstat;
+#endif
 } ARC_ListMutex;
 
 int init_mutex(ARC_Mutex **mutex);
 int uninit_mutex(ARC_Mutex *mutex);
 int init_static_mutex(ARC_Mutex *mutex);
 int mutex_lock(ARC_Mutex *mutex);
+/**
+ * Attempt to lock the mutex without waiting.
+ *
+ * @return 0 if the mutex was locked, -1 if it is held, 1 on error.
+ * */
+int mutex_trylock(ARC_Mutex *mutex);
+/**
+ * Lock the mutex, marking it as contended.
+ *
+ * The next unlock will wake a thread sleeping on the mutex. Used by
+ * primitives which move sleeping threads onto the mutex (see ARC_CondVar).
+ * */
+int mutex_lock_contended(ARC_Mutex *mutex);
 int mutex_unlock(ARC_Mutex *mutex);
 
 int init_list_mutex(ARC_ListMutex **mutex);
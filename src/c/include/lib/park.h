@@ -0,0 +1,109 @@
+/**
+ * @file park.h
+ *
+ * @author awewsomegamer <awewsomegamer@gmail.com>
+ *
+ * @LICENSE
+ * Arctan-OS/Klib - Generic Kernel Functions and Data Structures
+ * Copyright (C) 2023-2026 awewsomegamer
+ *
+ * This file is part of Arctan-OS/Klib.
+ *
+ * Arctan-OS/Klib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * @DESCRIPTION
+*/
+#ifndef ARC_LIB_PARK_H
+#define ARC_LIB_PARK_H
+
+#include <stdint.h>
+
+/**
+ * Address-keyed wait queues
+ *
+ * Threads park on an arbitrary address and are woken by whoever
+ * changes the value behind it. Waiters are kept in a fixed table of
+ * hashed buckets, so no state has to be embedded in the object that
+ * is waited on.
+ * */
+
+/// Number of hash buckets, must be a power of two
+#ifndef ARC_PARK_BUCKETS
+#define ARC_PARK_BUCKETS 256
+#endif
+
+/// Pass to park_wake to wake every waiter
+#define ARC_PARK_ALL INT32_MAX
+
+/// Decides, with the bucket locked, whether the caller should still park
+typedef int (*ARC_ParkValidate)(void *addr, void *arg);
+
+/**
+ * Park the calling thread on an address.
+ *
+ * The thread only parks if *addr still equals expected once the
+ * bucket is locked, so a wake which follows a change of *addr cannot
+ * be missed.
+ *
+ * @param uint64_t *addr - Address to wait on.
+ * @param uint64_t expected - Value *addr must hold for the thread to park.
+ * @return 0 if woken, -1 if *addr did not hold expected.
+ * */
+int park_wait(uint64_t *addr, uint64_t expected);
+
+/**
+ * Park with a deadline.
+ *
+ * @param uint64_t deadline - Clock value (see schedhooks_now) at which
+ * to give up, 0 for none.
+ * @return 0 if woken, -1 if *addr did not hold expected, -2 on timeout.
+ * */
+int park_wait_timeout(uint64_t *addr, uint64_t expected, uint64_t deadline);
+
+/**
+ * Park with a custom check.
+ *
+ * Like park_wait_timeout, but validate(addr, arg) is called with the
+ * bucket locked and the thread only parks if it returns non-zero.
+ * validate must not block or park.
+ * */
+int park_wait_cond(void *addr, ARC_ParkValidate validate, void *arg, uint64_t deadline);
+
+/**
+ * Wake threads parked on an address.
+ *
+ * Threads are woken in the order they parked.
+ *
+ * @param void *addr - Address the threads are parked on.
+ * @param int n - Maximum number of threads to wake, ARC_PARK_ALL for all.
+ * @return the number of threads woken.
+ * */
+int park_wake(void *addr, int n);
+
+/**
+ * Wake some threads parked on an address and move others to another.
+ *
+ * Moved threads stay asleep and are woken by a later park_wake on the
+ * new address. This lets a primitive hand a crowd of waiters over to a
+ * lock without waking them all to fight for it.
+ *
+ * @param void *from - Address the threads are parked on.
+ * @param void *to - Address to move the threads to.
+ * @param int n_wake - Maximum number of threads to wake.
+ * @param int n_requeue - Maximum number of threads to move.
+ * @return the number of threads woken or moved.
+ * */
+int park_requeue(void *from, void *to, int n_wake, int n_requeue);
+
+#endif
@@ -0,0 +1,80 @@
+/**
+ * @file percpu.h
+ *
+ * @author awewsomegamer <awewsomegamer@gmail.com>
+ *
+ * @LICENSE
+ * Arctan-OS/Klib - Generic Kernel Functions and Data Structures
+ * Copyright (C) 2023-2026 awewsomegamer
+ *
+ * This file is part of Arctan-OS/Klib.
+ *
+ * Arctan-OS/Klib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * @DESCRIPTION
+*/
+#ifndef ARC_LIB_PERCPU_H
+#define ARC_LIB_PERCPU_H
+
+#include <stdint.h>
+
+/// Maximum number of processors klib keeps per-CPU state for
+#ifndef ARC_PERCPU_MAX
+#define ARC_PERCPU_MAX 64
+#endif
+
+/// Maximum number of memory nodes (sockets, clusters) klib distinguishes
+#ifndef ARC_PERCPU_NODES_MAX
+#define ARC_PERCPU_NODES_MAX 8
+#endif
+
+/// Returns the ID of the calling processor (or of its node)
+typedef uint32_t (*ARC_PercpuIDFn)();
+
+/**
+ * Provide klib with a way to identify the calling processor.
+ *
+ * get_id must return IDs from 0 to count - 1. Fails if count is larger
+ * than ARC_PERCPU_MAX. Until this is called every caller is treated as
+ * processor 0, which is only correct before other processors are started.
+ * */
+int init_percpu(ARC_PercpuIDFn get_id, uint32_t count);
+
+/**
+ * Get the ID of the calling processor.
+ *
+ * The result is always less than ARC_PERCPU_MAX, an ID outside of the
+ * count given to init_percpu hangs the kernel. It is only stable while
+ * the caller cannot be migrated (i.e. with interrupts disabled).
+ * */
+uint32_t percpu_id();
+
+/**
+ * Provide klib with the node (socket or cluster) of the calling processor.
+ *
+ * get_node must return IDs from 0 to count - 1. Fails if count is larger
+ * than ARC_PERCPU_NODES_MAX. Until this is called every processor is
+ * treated as being on node 0.
+ * */
+int init_percpu_nodes(ARC_PercpuIDFn get_node, uint32_t count);
+
+/**
+ * Get the node of the calling processor.
+ *
+ * The result is always less than ARC_PERCPU_NODES_MAX, a node outside of
+ * the count given to init_percpu_nodes hangs the kernel.
+ * */
+uint32_t percpu_node();
+
+#endif
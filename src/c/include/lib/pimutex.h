@@ -0,0 +1,87 @@
+/**
+ * @file pimutex.h
+ *
+ * @author awewsomegamer <awewsomegamer@gmail.com>
+ *
+ * @LICENSE
+ * Arctan-OS/Klib - Generic Kernel Functions and Data Structures
+ * Copyright (C) 2023-2026 awewsomegamer
+ *
+ * This file is part of Arctan-OS/Klib.
+ *
+ * Arctan-OS/Klib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * @DESCRIPTION
+*/
+#ifndef ARC_LIB_PIMUTEX_H
+#define ARC_LIB_PIMUTEX_H
+
+#include <stdint.h>
+
+/// Longest chain of blocked owners a priority boost is passed along
+#ifndef ARC_PIMUTEX_MAX_CHAIN
+#define ARC_PIMUTEX_MAX_CHAIN 16
+#endif
+
+/**
+ * Priority-inheritance mutex
+ *
+ * While threads wait on the mutex, its owner runs at (at least) the
+ * priority of the most urgent waiter. If the owner is itself waiting on
+ * another PI mutex, the boost is passed on to that mutex's owner, and
+ * so on. The mutex is handed directly to the most urgent waiter when it
+ * is released. Priorities are read and changed through the scheduler
+ * hooks (see ARC_SchedHooks), which also give the ARC_PIState of each
+ * thread.
+ * */
+typedef struct ARC_PIMutex {
+        /// Owning thread, with bit 0 set if threads are waiting
+        uint64_t owner;
+        /// Waiting threads, most urgent first
+        void *waiters;
+        /// Next contended mutex held by the same owner
+        struct ARC_PIMutex *next_held;
+} ARC_PIMutex;
+
+/**
+ * Per-thread PI state
+ *
+ * Kept by the kernel in each thread and found through the pi_state
+ * scheduler hook, so that contended locking never has to allocate.
+ * Only used by the PI mutexes while the thread owns or waits on a
+ * contended one.
+ * */
+typedef struct ARC_PIState {
+        /// Set while the rest of the state is in use
+        uint32_t active;
+        /// Priority without any boosts
+        int base;
+        /// Priority currently given to the scheduler
+        int prio;
+        /// Contended mutexes the thread owns
+        struct ARC_PIMutex *held;
+        /// The thread's entry in the queue of the mutex it waits on
+        void *blocked;
+} ARC_PIState;
+
+int init_pimutex(ARC_PIMutex **mutex);
+int uninit_pimutex(ARC_PIMutex *mutex);
+int init_static_pimutex(ARC_PIMutex *mutex);
+int pimutex_lock(ARC_PIMutex *mutex);
+/// Returns 0 if the mutex was locked, -1 if it is held
+int pimutex_trylock(ARC_PIMutex *mutex);
+/// Returns 0 if the mutex was unlocked, 1 if the caller does not own it
+int pimutex_unlock(ARC_PIMutex *mutex);
+
+#endif
@@ -0,0 +1,60 @@
+/**
+ * @file qspinlock.h
+ *
+ * @author awewsomegamer <awewsomegamer@gmail.com>
+ *
+ * @LICENSE
+ * Arctan-OS/Klib - Generic Kernel Functions and Data Structures
+ * Copyright (C) 2023-2026 awewsomegamer
+ *
+ * This file is part of Arctan-OS/Klib.
+ *
+ * Arctan-OS/Klib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * @DESCRIPTION
+*/
+#ifndef ARC_LIB_QSPINLOCK_H
+#define ARC_LIB_QSPINLOCK_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "lib/irq.h"
+
+/**
+ * Queued spinlock
+ *
+ * Drop-in alternative to ARC_Spinlock for contended locks. The lock
+ * word packs a locked byte (bits 0-7) and the tail of a queue of
+ * waiters (bits 16-31). Each waiter spins on its own per-CPU node,
+ * and the lock is handed off in FIFO order.
+ * */
+typedef struct ARC_QSpinlock {
+        uint32_t val;
+        ARC_IRQFlags interrupts;
+} ARC_QSpinlock;
+
+int init_qspinlock(ARC_QSpinlock **lock);
+int uninit_qspinlock(ARC_QSpinlock *lock);
+int init_static_qspinlock(ARC_QSpinlock *lock);
+int qspinlock_lock(ARC_QSpinlock *lock);
+/**
+ * Attempt to acquire the lock without waiting.
+ *
+ * @return 0 if the lock was acquired, -1 if it is held, 1 on error.
+ * */
+int qspinlock_trylock(ARC_QSpinlock *lock);
+int qspinlock_unlock(ARC_QSpinlock *lock);
+
+#endif
@@ -0,0 +1,105 @@
+/**
+ * @file recordring.h
+ *
+ * @author awewsomegamer <awewsomegamer@gmail.com>
+ *
+ * @LICENSE
+ * Arctan-OS/Klib - Generic Kernel Functions and Data Structures
+ * Copyright (C) 2023-2026 awewsomegamer
+ *
+ * This file is part of Arctan-OS/Klib.
+ *
+ * Arctan-OS/Klib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * @DESCRIPTION
+*/
+#ifndef ARC_LIB_RECORDRING_H
+#define ARC_LIB_RECORDRING_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <lib/atomics.h>
+#include <lib/spinlock.h>
+
+/**
+ * Variable-length record ring
+ *
+ * Records are stored back to back, each behind an 8 byte header giving
+ * its length, and padded to a multiple of 8 bytes. A record which would
+ * run past the end of the buffer is placed at the start instead, behind
+ * a padding record which the consumer skips. Any number of producers
+ * may reserve space at once, a single consumer reads records in place.
+ *
+ * Reservations are serialized by a short spinlock held with interrupts
+ * disabled, commits are lock-free. Each header carries a busy flag until
+ * its record is committed, and the consumer stops at the first busy
+ * record: a producer which is slow to commit (or was preempted) holds
+ * back the records behind it from the consumer, but never the producers.
+ * Reserving and committing from interrupt handlers is therefore safe.
+ * */
+typedef struct ARC_RecordRing {
+	void *base; // The start of the buffer
+	size_t size; // Size of the buffer in bytes, a power of two
+	size_t mask; // size - 1
+	struct {
+		size_t head; // Free running byte count reserved by producers
+		ARC_Spinlock lock; // Serializes reservations
+	} __attribute__((aligned(ARC_CACHE_LINE))) producer;
+	struct {
+		size_t tail; // Free running byte count consumed
+	} __attribute__((aligned(ARC_CACHE_LINE))) consumer;
+} ARC_RecordRing;
+
+/// A record being written or read
+typedef struct ARC_Record {
+	void *data; // The record's contents
+	size_t length; // Length of the contents in bytes
+	size_t pos; // Position of the record (or of the padding before it)
+	size_t total; // Bytes taken up, including the header and padding
+} ARC_Record;
+
+/**
+ * Reserve space for a record.
+ *
+ * The caller fills record->data in place and passes the record to
+ * record_ring_commit. Commits never wait, but the consumer reads records
+ * in the order they were reserved, so a record only becomes visible once
+ * every record reserved before it was committed as well.
+ *
+ * @return 0 upon success, 1 upon bad arguments (or a record, with its
+ * header, bigger than half the buffer), -2 if the buffer is full.
+ * */
+int record_ring_reserve(ARC_RecordRing *ring, size_t length, ARC_Record *record);
+int record_ring_commit(ARC_RecordRing *ring, ARC_Record *record);
+
+/**
+ * Get the oldest committed record without copying it.
+ *
+ * @return 0 upon success, 1 upon bad arguments, -2 if there is no
+ * committed record.
+ * */
+int record_ring_peek(ARC_RecordRing *ring, ARC_Record *record);
+/// Free the record returned by record_ring_peek
+int record_ring_consume(ARC_RecordRing *ring, ARC_Record *record);
+
+/**
+ * Create a record ring.
+ *
+ * @param void *base - 8 byte aligned buffer.
+ * @param size_t size - Size of the buffer, a power of two.
+ * */
+ARC_RecordRing *init_record_ring(void *base, size_t size);
+int uninit_record_ring(ARC_RecordRing *ring);
+
+#endif
@@ -29,7 +29,34 @@
 
 #include <stdint.h>
 #include <stddef.h>
+#include <lib/atomics.h>
 #include <lib/mutex.h>
+#include <lib/condvar.h>
+
+/// Every operation takes the buffer's mutex
+#define ARC_RINGBUFFER_LOCKED 0
+/// Lock-free, for one producer and one consumer thread
+#define ARC_RINGBUFFER_SPSC   1
+/// Lock-free, for any number of producers and consumers
+#define ARC_RINGBUFFER_MPMC   2
+/// Producers never wait, overwriting the oldest objects, readers use cursors
+#define ARC_RINGBUFFER_OVERWRITE 3
+/// OR-ed into a mode to map the buffer twice back to back (see ARC_RingbufferVMHooks)
+#define ARC_RINGBUFFER_MIRRORED 0x100
+
+/**
+ * Virtual memory callbacks for mirrored ringbuffers
+ * */
+typedef struct ARC_RingbufferVMHooks {
+        /**
+         * Map size bytes of fresh memory twice, with the second mapping
+         * directly following the first, and return the start of the
+         * first. size is a multiple of the page size.
+         * */
+        void *(*map_mirrored)(size_t size);
+        /// Undo map_mirrored
+        int (*unmap_mirrored)(void *base, size_t size);
+} ARC_RingbufferVMHooks;
 
 typedef struct ARC_Ringbuffer {
 	void *base; // The start of the buffer
@@ -38,13 +65,220 @@ typedef struct ARC_Ringbuffer {
 	size_t idx; // The current 0-based index of the next free object
 	size_t data_tail;
 	ARC_Mutex lock;
+	ARC_CondVar space; // Signalled when objects are freed
+	int mode; // ARC_RINGBUFFER_*
+	int mirrored; // The buffer is mapped again at base + objs * obj_size
+	size_t mask; // objs - 1 in the lock-free modes, where objs is a power of two
+	size_t data_watermark; // Sleeping consumers are woken once this many objects are queued
+	size_t space_watermark; // Sleeping producers are woken once this many objects are free
+	uint64_t data_waiters; // Consumers sleeping until there are objects
+	uint64_t space_waiters; // Producers sleeping until there is space
+	size_t *seq; // MPMC: per object sequence, says whose turn it is to use the object
+	             // OVERWRITE: per object sequence, says which position the object holds
+	// NOTE: The producer and consumer sides are kept on separate cache
+	//       lines, each with a copy of the other side's index which is
+	//       only refreshed when the buffer looks full (or empty)
+	struct {
+		size_t head; // Free running count of objects pushed
+		size_t tail_cache;
+	} __attribute__((aligned(ARC_CACHE_LINE))) producer;
+	struct {
+		size_t tail; // Free running count of objects popped
+		size_t head_cache;
+	} __attribute__((aligned(ARC_CACHE_LINE))) consumer;
 } ARC_Ringbuffer;
 
+/**
+ * Objects reserved in, or peeked from, a ringbuffer
+ *
+ * The objects are contiguous unless they wrap around the end of the
+ * buffer, in which case they are split into two parts. Mirrored buffers
+ * always give a single part.
+ * */
+typedef struct ARC_RingbufferSpan {
+	void *base[2]; // Start of each part
+	size_t count[2]; // Objects in each part
+	size_t pos; // Position of the first object
+	size_t total; // count[0] + count[1]
+} ARC_RingbufferSpan;
+
+/**
+ * Reader position in an ARC_RINGBUFFER_OVERWRITE ringbuffer
+ *
+ * Each reader has its own cursor, readers do not consume objects.
+ * */
+typedef struct ARC_RingbufferCursor {
+	size_t pos; // Position of the next object to read
+	size_t missed; // Objects overwritten before they could be read
+} ARC_RingbufferCursor;
+
 size_t ringbuffer_allocate(ARC_Ringbuffer *ringbuffer, int block);
 int ringbuffer_free(ARC_Ringbuffer *ringbuffer, size_t idx);
 
 size_t ringbuffer_write(ARC_Ringbuffer *ringbuffer, size_t idx, void *data);
 
+/**
+ * Copy an object into the buffer.
+ *
+ * Does not wake consumers sleeping in ringbuffer_pop_wait, use
+ * ringbuffer_push_wake if there may be any.
+ *
+ * @return 0 upon success, 1 upon bad arguments, -2 if the buffer is full.
+ * */
+int ringbuffer_push(ARC_Ringbuffer *ringbuffer, void *data);
+
+/**
+ * Copy the oldest object out of the buffer.
+ *
+ * Not supported in ARC_RINGBUFFER_OVERWRITE mode, see ringbuffer_read.
+ * Does not wake producers sleeping in ringbuffer_push_wait, use
+ * ringbuffer_pop_wake if there may be any.
+ *
+ * @return 0 upon success, 1 upon bad arguments, -2 if the buffer is empty.
+ * */
+int ringbuffer_pop(ARC_Ringbuffer *ringbuffer, void *data);
+
+/**
+ * Push, then wake sleeping consumers once the data watermark is reached.
+ *
+ * NOTE: Waking costs a full fence and a look at both sides of the
+ *       buffer, which is why ringbuffer_push leaves it out. Sleepers
+ *       are only woken by the _wake, _wait and _timeout functions.
+ * */
+int ringbuffer_push_wake(ARC_Ringbuffer *ringbuffer, void *data);
+/// Pop, then wake sleeping producers once the space watermark is reached
+int ringbuffer_pop_wake(ARC_Ringbuffer *ringbuffer, void *data);
+
+/**
+ * Push, sleeping while the buffer is full.
+ *
+ * Not supported in ARC_RINGBUFFER_OVERWRITE mode, where pushing never
+ * has to wait.
+ * */
+int ringbuffer_push_wait(ARC_Ringbuffer *ringbuffer, void *data);
+/**
+ * Push, sleeping while the buffer is full for at most the given time.
+ *
+ * @param uint64_t timeout - Time to wait, in the units of schedhooks_now.
+ * @return 0 upon success, 1 upon bad arguments, -2 on timeout.
+ * */
+int ringbuffer_push_timeout(ARC_Ringbuffer *ringbuffer, void *data, uint64_t timeout);
+
+/// Pop, sleeping while the buffer is empty
+int ringbuffer_pop_wait(ARC_Ringbuffer *ringbuffer, void *data);
+/**
+ * Pop, sleeping while the buffer is empty for at most the given time.
+ *
+ * @param uint64_t timeout - Time to wait, in the units of schedhooks_now.
+ * @return 0 upon success, 1 upon bad arguments, -2 on timeout.
+ * */
+int ringbuffer_pop_timeout(ARC_Ringbuffer *ringbuffer, void *data, uint64_t timeout);
+
+/**
+ * Set how full (or empty) the buffer has to get before sleepers are woken.
+ *
+ * Waking a sleeper only once several objects can be handled saves a wake
+ * per object. A consumer sleeping on a buffer which stops filling up
+ * before reaching the watermark stays asleep, so consumers should use
+ * timeouts with watermarks above 1. Both default to 1.
+ *
+ * @param size_t data - Objects which must be queued to wake consumers.
+ * @param size_t space - Free objects needed to wake producers.
+ * */
+int ringbuffer_set_watermarks(ARC_Ringbuffer *ringbuffer, size_t data, size_t space);
+
+/// Returned by ringbuffer_poll if an object can be popped
+#define ARC_RINGBUFFER_POLLIN  1
+/// Returned by ringbuffer_poll if an object can be pushed
+#define ARC_RINGBUFFER_POLLOUT 2
+
+/**
+ * Check whether the buffer can be pushed to or popped from.
+ *
+ * In ARC_RINGBUFFER_OVERWRITE mode pushing is always possible and only
+ * ARC_RINGBUFFER_POLLOUT is returned, as whether there is anything to
+ * read depends on the reader (see ringbuffer_cursor_poll).
+ *
+ * @return a combination of ARC_RINGBUFFER_POLLIN and ARC_RINGBUFFER_POLLOUT.
+ * */
+int ringbuffer_poll(ARC_Ringbuffer *ringbuffer);
+
+/**
+ * Start reading an ARC_RINGBUFFER_OVERWRITE ringbuffer.
+ *
+ * Points the cursor at the oldest object still in the buffer.
+ * */
+int ringbuffer_cursor_init(ARC_Ringbuffer *ringbuffer, ARC_RingbufferCursor *cursor);
+
+/**
+ * Copy the next object at a cursor.
+ *
+ * If the objects at the cursor were overwritten, the cursor skips ahead
+ * to the oldest object still in the buffer and the number of objects
+ * skipped is added to cursor->missed.
+ *
+ * @return 0 upon success, 1 upon bad arguments, -2 if there is no new
+ * object yet.
+ * */
+int ringbuffer_read(ARC_Ringbuffer *ringbuffer, ARC_RingbufferCursor *cursor, void *data);
+
+/**
+ * Check whether ringbuffer_read would find an object at a cursor.
+ *
+ * @return ARC_RINGBUFFER_POLLOUT, along with ARC_RINGBUFFER_POLLIN if
+ * there is something to read. 0 upon bad arguments.
+ * */
+int ringbuffer_cursor_poll(ARC_Ringbuffer *ringbuffer, ARC_RingbufferCursor *cursor);
+
+/**
+ * Reserve up to n objects for the caller to fill in place.
+ *
+ * The objects become visible to consumers once passed to
+ * ringbuffer_commit. In ARC_RINGBUFFER_LOCKED mode the buffer stays
+ * locked until then, in ARC_RINGBUFFER_SPSC mode the producer may only
+ * have one reservation outstanding.
+ *
+ * @return the number of objects reserved, 0 if the buffer is full.
+ * */
+size_t ringbuffer_reserve(ARC_Ringbuffer *ringbuffer, size_t n, ARC_RingbufferSpan *span);
+int ringbuffer_commit(ARC_Ringbuffer *ringbuffer, ARC_RingbufferSpan *span);
+/// Commit, then wake sleeping consumers like ringbuffer_push_wake
+int ringbuffer_commit_wake(ARC_Ringbuffer *ringbuffer, ARC_RingbufferSpan *span);
+
+/**
+ * Get up to n of the oldest objects to be read in place.
+ *
+ * The objects are given back to producers once passed to
+ * ringbuffer_release, with the same restrictions as ringbuffer_reserve.
+ *
+ * @return the number of objects available, 0 if the buffer is empty.
+ * */
+size_t ringbuffer_peek(ARC_Ringbuffer *ringbuffer, size_t n, ARC_RingbufferSpan *span);
+int ringbuffer_release(ARC_Ringbuffer *ringbuffer, ARC_RingbufferSpan *span);
+/// Release, then wake sleeping producers like ringbuffer_pop_wake
+int ringbuffer_release_wake(ARC_Ringbuffer *ringbuffer, ARC_RingbufferSpan *span);
+
 ARC_Ringbuffer *init_ringbuffer(void *base, size_t objs, size_t obj_size);
 
+/**
+ * Create a ringbuffer with the given mode.
+ *
+ * The lock-free modes need objs to be a power of two, and do not support
+ * ringbuffer_allocate, ringbuffer_free and ringbuffer_write.
+ *
+ * With ARC_RINGBUFFER_MIRRORED, base must be NULL and the memory is
+ * mapped through the hooks given to init_ringbuffer_vm, so that any run
+ * of up to objs objects is contiguous. objs * obj_size must then be a
+ * multiple of the page size.
+ * */
+ARC_Ringbuffer *init_ringbuffer_mode(void *base, size_t objs, size_t obj_size, int mode);
+
+/**
+ * Install the virtual memory callbacks used by mirrored ringbuffers.
+ *
+ * The structure is copied.
+ * */
+int init_ringbuffer_vm(ARC_RingbufferVMHooks *hooks);
+int uninit_ringbuffer(ARC_Ringbuffer *ringbuffer);
+
 #endif
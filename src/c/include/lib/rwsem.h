@@ -0,0 +1,74 @@
+/**
+ * @file rwsem.h
+ *
+ * @author awewsomegamer <awewsomegamer@gmail.com>
+ *
+ * @LICENSE
+ * Arctan-OS/Klib - Generic Kernel Functions and Data Structures
+ * Copyright (C) 2023-2026 awewsomegamer
+ *
+ * This file is part of Arctan-OS/Klib.
+ *
+ * Arctan-OS/Klib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * @DESCRIPTION
+*/
+#ifndef ARC_LIB_RWSEM_H
+#define ARC_LIB_RWSEM_H
+
+#include <stdint.h>
+
+#include "lib/mutex.h"
+
+/**
+ * Sleeping reader-writer semaphore
+ *
+ * For long read-mostly critical sections: readers overlap, and
+ * waiters sleep rather than spin. count holds the number of readers,
+ * a writer bit and a bit telling that threads are queued. Once a
+ * thread is queued, newcomers queue behind it, so writers cannot be
+ * starved by a stream of readers. When the semaphore is released it
+ * is handed to either the first queued writer or all readers at the
+ * front of the queue at once.
+ * */
+typedef struct ARC_RWSem {
+        uint64_t count;
+        /// Protects the queue
+        ARC_Mutex wait_lock;
+        void *head;
+        void *tail;
+} ARC_RWSem;
+
+int init_rwsem(ARC_RWSem **sem);
+int uninit_rwsem(ARC_RWSem *sem);
+int init_static_rwsem(ARC_RWSem *sem);
+
+int rwsem_read_lock(ARC_RWSem *sem);
+/// Returns 0 if the semaphore was acquired, -1 if it is busy
+int rwsem_read_trylock(ARC_RWSem *sem);
+int rwsem_read_unlock(ARC_RWSem *sem);
+
+int rwsem_write_lock(ARC_RWSem *sem);
+/// Returns 0 if the semaphore was acquired, -1 if it is busy
+int rwsem_write_trylock(ARC_RWSem *sem);
+int rwsem_write_unlock(ARC_RWSem *sem);
+
+/**
+ * Turn a held write lock into a read lock.
+ *
+ * Readers queued at the front are let in along with the caller.
+ * */
+int rwsem_downgrade(ARC_RWSem *sem);
+
+#endif
@@ -0,0 +1,87 @@
+/**
+ * @file rwspinlock.h
+ *
+ * @author awewsomegamer <awewsomegamer@gmail.com>
+ *
+ * @LICENSE
+ * Arctan-OS/Klib - Generic Kernel Functions and Data Structures
+ * Copyright (C) 2023-2026 awewsomegamer
+ *
+ * This file is part of Arctan-OS/Klib.
+ *
+ * Arctan-OS/Klib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * @DESCRIPTION
+*/
+#ifndef ARC_LIB_RWSPINLOCK_H
+#define ARC_LIB_RWSPINLOCK_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "lib/atomics.h"
+#include "lib/percpu.h"
+
+/**
+ * Reader-writer spinlock
+ *
+ * Any number of readers or a single writer may hold the lock. The
+ * lock word holds the reader count (bits 0-15), the number of waiting
+ * writers (bits 16-30) and the writer bit (bit 31). New readers are
+ * turned away while a writer is waiting, so writers cannot starve.
+ *
+ * NOTE: Unlike ARC_Spinlock, these locks do not touch the interrupt
+ *       flag.
+ * */
+typedef struct ARC_RWSpinlock {
+        uint32_t lock;
+} ARC_RWSpinlock;
+
+/**
+ * Reader-biased ("big reader") spinlock
+ *
+ * Readers only touch the counter of the processor they run on, so
+ * read-mostly locks do not bounce a shared cache line. Writers pay
+ * for this by having to check every processor's counter.
+ * */
+typedef struct ARC_BRSpinlock {
+        struct {
+                int32_t count;
+        } __attribute__((aligned(ARC_CACHE_LINE))) readers[ARC_PERCPU_MAX];
+        uint32_t writer;
+} ARC_BRSpinlock;
+
+int init_rwspinlock(ARC_RWSpinlock **lock);
+int uninit_rwspinlock(ARC_RWSpinlock *lock);
+int init_static_rwspinlock(ARC_RWSpinlock *lock);
+int rwspinlock_read_lock(ARC_RWSpinlock *lock);
+/// Returns 0 if the lock was acquired, -1 if it is busy
+int rwspinlock_read_trylock(ARC_RWSpinlock *lock);
+int rwspinlock_read_unlock(ARC_RWSpinlock *lock);
+int rwspinlock_write_lock(ARC_RWSpinlock *lock);
+/// Returns 0 if the lock was acquired, -1 if it is busy
+int rwspinlock_write_trylock(ARC_RWSpinlock *lock);
+int rwspinlock_write_unlock(ARC_RWSpinlock *lock);
+/// Atomically turn a held write lock into a read lock
+int rwspinlock_downgrade(ARC_RWSpinlock *lock);
+
+int init_brspinlock(ARC_BRSpinlock **lock);
+int uninit_brspinlock(ARC_BRSpinlock *lock);
+int init_static_brspinlock(ARC_BRSpinlock *lock);
+int brspinlock_read_lock(ARC_BRSpinlock *lock);
+int brspinlock_read_unlock(ARC_BRSpinlock *lock);
+int brspinlock_write_lock(ARC_BRSpinlock *lock);
+int brspinlock_write_unlock(ARC_BRSpinlock *lock);
+
+#endif
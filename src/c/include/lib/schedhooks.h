@@ -0,0 +1,114 @@
+/**
+ * @file schedhooks.h
+ *
+ * @author awewsomegamer <awewsomegamer@gmail.com>
+ *
+ * @LICENSE
+ * Arctan-OS/Klib - Generic Kernel Functions and Data Structures
+ * Copyright (C) 2023-2026 awewsomegamer
+ *
+ * This file is part of Arctan-OS/Klib.
+ *
+ * Arctan-OS/Klib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * @DESCRIPTION
+*/
+#ifndef ARC_LIB_SCHEDHOOKS_H
+#define ARC_LIB_SCHEDHOOKS_H
+
+#include "userspace/thread.h"
+#include <stdint.h>
+
+struct ARC_PIState;
+
+/**
+ * Optional scheduler callbacks used by klib's locks
+ *
+ * Any callback may be left NULL, klib then falls back to behaviour
+ * which only relies on sched_yield and sched_current_thread.
+ * */
+typedef struct ARC_SchedHooks {
+        /// Returns non-zero if the thread is currently running on a processor
+        int (*on_cpu)(ARC_Thread *thread);
+        /**
+         * Block the calling thread until it is unblocked or the deadline
+         * (in the units of now, 0 for none) passes. If the thread was
+         * unblocked since it last returned from block, return at once.
+         * Returns 0 if unblocked, -1 on timeout, spurious returns are fine.
+         * */
+        int (*block)(uint64_t deadline);
+        /// Let a thread blocked (or about to block) in block continue
+        int (*unblock)(ARC_Thread *thread);
+        /// Current value of a monotonic clock, used for deadlines
+        uint64_t (*now)();
+        /// Get the priority a thread runs at, larger values are more urgent
+        int (*get_priority)(ARC_Thread *thread);
+        /// Change the priority a thread runs at
+        int (*set_priority)(ARC_Thread *thread, int priority);
+        /**
+         * Get the PI mutex state kept in a thread (see ARC_PIState). The
+         * storage must be zeroed when the thread is created and live as
+         * long as the thread does.
+         * */
+        struct ARC_PIState *(*pi_state)(ARC_Thread *thread);
+} ARC_SchedHooks;
+
+/**
+ * Install the scheduler callbacks.
+ *
+ * The structure is copied.
+ * */
+int init_sched_hooks(ARC_SchedHooks *hooks);
+
+/**
+ * Check if a thread is running.
+ *
+ * Without an on_cpu callback every non-NULL thread is assumed to be
+ * running, callers are expected to bound how long they act on this.
+ * */
+int schedhooks_on_cpu(ARC_Thread *thread);
+
+/**
+ * Block the calling thread.
+ *
+ * Without a block callback this yields once and returns, turning the
+ * caller's wait loop into polling.
+ * */
+int schedhooks_block(uint64_t deadline);
+int schedhooks_unblock(ARC_Thread *thread);
+
+/**
+ * Read the clock used for deadlines.
+ *
+ * Without a now callback this is always 0 and deadlines never pass.
+ * */
+uint64_t schedhooks_now();
+
+/**
+ * Get and set thread priorities.
+ *
+ * Without callbacks every thread has priority 0 and setting does nothing.
+ * */
+int schedhooks_get_priority(ARC_Thread *thread);
+int schedhooks_set_priority(ARC_Thread *thread, int priority);
+
+/**
+ * Get the PI mutex state of a thread.
+ *
+ * Without a pi_state callback this is NULL, and PI mutexes queue their
+ * waiters by priority without boosting the owner.
+ * */
+struct ARC_PIState *schedhooks_pi_state(ARC_Thread *thread);
+
+#endif
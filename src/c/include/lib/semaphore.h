@@ -0,0 +1,60 @@
+/**
+ * @file semaphore.h
+ *
+ * @author awewsomegamer <awewsomegamer@gmail.com>
+ *
+ * @LICENSE
+ * Arctan-OS/Klib - Generic Kernel Functions and Data Structures
+ * Copyright (C) 2023-2026 awewsomegamer
+ *
+ * This file is part of Arctan-OS/Klib.
+ *
+ * Arctan-OS/Klib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * @DESCRIPTION
+*/
+#ifndef ARC_LIB_SEMAPHORE_H
+#define ARC_LIB_SEMAPHORE_H
+
+#include <stdint.h>
+
+/**
+ * Counting semaphore
+ *
+ * down takes a unit, sleeping until one is available, up returns one.
+ * Neither touches anything but the counter unless a thread is asleep.
+ * */
+typedef struct ARC_Semaphore {
+        uint64_t count;
+        /// Number of threads in the sleeping path of down
+        uint64_t waiters;
+} ARC_Semaphore;
+
+int init_semaphore(ARC_Semaphore **sem, uint64_t count);
+int uninit_semaphore(ARC_Semaphore *sem);
+int init_static_semaphore(ARC_Semaphore *sem, uint64_t count);
+
+int semaphore_down(ARC_Semaphore *sem);
+/// Returns 0 if a unit was taken, -1 if none is available
+int semaphore_trydown(ARC_Semaphore *sem);
+/**
+ * Take a unit, giving up after the given time.
+ *
+ * @param uint64_t timeout - Time to wait, in the units of schedhooks_now.
+ * @return 0 if a unit was taken, -2 on timeout.
+ * */
+int semaphore_down_timeout(ARC_Semaphore *sem, uint64_t timeout);
+int semaphore_up(ARC_Semaphore *sem);
+
+#endif
@@ -30,10 +30,16 @@
 #include <stdbool.h>
 #include <stdint.h>
 
+#include "lib/irq.h"
+#include "lib/lockstat.h"
+
 /// Generic spinlock
 typedef struct ARC_Spinlock {
         uint32_t lock;
-        bool interrupts;
+        ARC_IRQFlags interrupts;
+#ifdef ARC_LOCKSTAT
+        ARC_LockStat lockstat;
+#endif
 } ARC_Spinlock;
 
 int init_spinlock(ARC_Spinlock **spinlock);
@@ -42,4 +48,21 @@ int init_static_spinlock(ARC_Spinlock *spinlock);
 int spinlock_lock(ARC_Spinlock *spinlock);
 int spinlock_unlock(ARC_Spinlock *spinlock);
 
+/**
+ * Lock and unlock without touching the interrupt state.
+ *
+ * Only for locks which are never taken from interrupt context, or when
+ * the caller has already disabled interrupts.
+ * */
+int spinlock_lock_raw(ARC_Spinlock *spinlock);
+int spinlock_unlock_raw(ARC_Spinlock *spinlock);
+
+/**
+ * Disable interrupts and lock, saving the previous interrupt state
+ * into *flags rather than into the lock.
+ * */
+int spinlock_lock_irqsave(ARC_Spinlock *spinlock, ARC_IRQFlags *flags);
+/// Unlock and restore the interrupt state saved by spinlock_lock_irqsave
+int spinlock_unlock_irqrestore(ARC_Spinlock *spinlock, ARC_IRQFlags flags);
+
 #endif
@@ -30,21 +30,64 @@
 #include <stdint.h>
 #include <stdbool.h>
 
-#include "lib/mutex.h"
+#include "lib/lockstat.h"
+#include "userspace/thread.h"
+
+/// Waiters this many tickets or more behind the owner back off between polls
+#ifndef ARC_TICKET_BACKOFF_DISTANCE
+#define ARC_TICKET_BACKOFF_DISTANCE 2
+#endif
+
+/// Waiters further than this behind the owner yield to the owner's thread
+#ifndef ARC_TICKET_YIELD_DISTANCE
+#define ARC_TICKET_YIELD_DISTANCE 8
+#endif
+
+/// Relax iterations between polls per ticket of distance from the owner
+#ifndef ARC_TICKET_BACKOFF_UNIT
+#define ARC_TICKET_BACKOFF_UNIT 32
+#endif
 
 /**
  * Queue lock structure
+ *
+ * The queue is a pair of 16-bit counters packed into one word:
+ * the ticket being served and the next ticket to hand out.
  * */
 struct ARC_TicketLock {
-	/// Pointer to the current owner of the lock
-	void *next;
-	/// Pointer to the last element in the queue
-	void *last;
-	/// Next ticket
-	uint64_t next_ticket;
-	/// Synchronization lock for the queue
-	ARC_Mutex lock;
-	bool is_frozen;
+	union {
+		uint32_t word;
+		struct {
+			/// Ticket which currently owns the lock
+			uint16_t owner;
+			/// Next ticket to hand out
+			uint16_t next;
+		};
+	} tickets;
+	/// Thread which owns the lock
+	ARC_Thread *holder;
+	/// ARC_TICKET_FROZEN and the freezer's ticket while frozen, otherwise 0
+	uint64_t is_frozen;
+#ifdef ARC_LOCKSTAT
+	ARC_LockStat lockstat;
+#endif
+};
+
+/// Set in ARC_TicketLock.is_frozen while the lock is frozen
+#define ARC_TICKET_FROZEN (1ULL << 32)
+
+/**
+ * Ticket in a queue lock
+ *
+ * May be supplied by the caller (on the stack or embedded
+ * in another structure) to lock without allocating.
+ * */
+struct ARC_Ticket {
+	struct ARC_TicketLock *parent;
+	uint64_t tid;
+	uint16_t ticket;
+	/// Set if the ticket was allocated by ticket_lock()
+	bool dynamic;
 };
 
 /**
@@ -71,6 +114,7 @@ int init_static_ticket_lock(struct ARC_TicketLock *head);
  * Enqueue calling thread.
  *
  * Enqueue the calling thread into the provided lock.
+ * The ticket is allocated and freed by ticket_unlock().
  *
  * @struct ARC_TicketLock *lock - The lock into which the calling thread should be enqueued.
  * @return the ticket.
@@ -78,11 +122,27 @@ int init_static_ticket_lock(struct ARC_TicketLock *head);
  * */
 void *ticket_lock(struct ARC_TicketLock *lock);
 
+/**
+ * Enqueue calling thread with a caller-supplied ticket.
+ *
+ * Takes a ticket with a single atomic operation, the
+ * caller then waits for it with ticket_lock_yield(). If
+ * the lock is frozen the caller sleeps until it is thawed.
+ *
+ * @param struct ARC_TicketLock *lock - The lock into which the calling thread should be enqueued.
+ * @param struct ARC_Ticket *ticket - Storage for the ticket, which must live until ticket_unlock().
+ * @return 0 upon success, 1 upon bad arguments.
+ * */
+int ticket_lock_node(struct ARC_TicketLock *lock, struct ARC_Ticket *ticket);
+
 /**
  * Yield current thread to lock owner thread.
  *
  * If the provided ticket is not the one which currently
- * owns the lock, then yield to the thread of that ticket.
+ * owns the lock, then wait for it. The next waiter in line
+ * spins, those further back poll less often the further back
+ * they are, and those more than ARC_TICKET_YIELD_DISTANCE
+ * behind yield to the thread holding the lock.
  * @param void *ticket - The ticket to wait for.
  * */
 void ticket_lock_yield(void *ticket);
@@ -98,7 +158,29 @@ void ticket_lock_yield(void *ticket);
  * */
 void *ticket_unlock(void *ticket);
 
+/**
+ * Freeze the lock and drain its queue.
+ *
+ * Called by the owner. Threads arriving at the lock from now on sleep
+ * until it is thawed, while the threads already queued are let through
+ * in order. The caller sleeps until the last of them has unlocked and
+ * then owns the lock again, with the ticket updated in place.
+ *
+ * @param void *ticket - The owner's ticket.
+ * @return 0 upon success, -1 if the caller is not the owner or the lock
+ * is already frozen.
+ * */
 int ticket_lock_freeze(void *ticket);
+
+/**
+ * Thaw a frozen lock.
+ *
+ * Wakes every thread which arrived while the lock was frozen. The caller
+ * keeps the lock until it calls ticket_unlock().
+ *
+ * @param void *ticket - The ticket used to freeze the lock.
+ * @return 0 upon success, -1 if the ticket did not freeze the lock.
+ * */
 int ticket_lock_thaw(void *ticket);
 
 #endif
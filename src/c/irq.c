@@ -0,0 +1,151 @@
+/**
+ * @file irq.c
+ *
+ * @author awewsomegamer <awewsomegamer@gmail.com>
+ *
+ * @LICENSE
+ * Arctan-OS/Klib - Generic Kernel Functions and Data Structures
+ * Copyright (C) 2023-2026 awewsomegamer
+ *
+ * This file is part of Arctan-OS/Klib.
+ *
+ * Arctan-OS/Klib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * @DESCRIPTION
+*/
+#include "lib/irq.h"
+#include "arch/info.h"
+#include "global.h"
+#include "util.h"
+#include "lib/atomics.h"
+#include "lib/percpu.h"
+
+#include <stdbool.h>
+
+#define IRQ_FLAGS_ENABLED 1
+
+struct internal_irq_state {
+	// Number of irq_save calls not yet restored on this processor
+	uint32_t soft_disabled;
+	// An interrupt came in while soft disabled and must be replayed
+	uint32_t pending;
+} __attribute__((aligned(ARC_CACHE_LINE)));
+
+static struct internal_irq_state irq_states[ARC_PERCPU_MAX];
+static ARC_IRQReplayFn irq_replay = NULL;
+static bool irq_lazy = false;
+
+// Drop a count raised on a processor the caller has since been migrated
+// away from. An interrupt may have been deferred on it because of this
+// count alone, nobody else would then replay it
+static void irq_undo_foreign(uint32_t cpu) {
+	struct internal_irq_state *state = &irq_states[cpu];
+
+	if (__atomic_sub_fetch(&state->soft_disabled, 1, __ATOMIC_SEQ_CST) != 0) {
+		return;
+	}
+
+	if (__atomic_exchange_n(&state->pending, 0, __ATOMIC_SEQ_CST) != 0) {
+		irq_replay(cpu);
+	}
+}
+
+ARC_IRQFlags irq_save() {
+	if (!irq_lazy) {
+		ARC_IRQFlags flags = arch_interrupts_enabled() ? IRQ_FLAGS_ENABLED : 0;
+		ARC_DISABLE_INTERRUPT;
+
+		return flags;
+	}
+
+	// NOTE: The caller can still be migrated between reading the
+	//       processor ID and raising the count, as interrupts are not
+	//       deferred yet. Check that the count went up on the
+	//       processor the caller is on now, and undo it if it did not
+	uint32_t cpu = percpu_id();
+	uint32_t prev = __atomic_fetch_add(&irq_states[cpu].soft_disabled, 1, __ATOMIC_SEQ_CST);
+
+	while (cpu != percpu_id()) {
+		irq_undo_foreign(cpu);
+		cpu = percpu_id();
+		prev = __atomic_fetch_add(&irq_states[cpu].soft_disabled, 1, __ATOMIC_SEQ_CST);
+	}
+
+	ARC_MEM_BARRIER;
+
+	return (prev == 0 && arch_interrupts_enabled()) ? IRQ_FLAGS_ENABLED : 0;
+}
+
+void irq_restore(ARC_IRQFlags flags) {
+	if (!irq_lazy) {
+		if (flags & IRQ_FLAGS_ENABLED) {
+			ARC_ENABLE_INTERRUPT;
+		}
+
+		return;
+	}
+
+	ARC_MEM_BARRIER;
+
+	// Interrupts are soft disabled, so the processor cannot change
+	uint32_t cpu = percpu_id();
+	struct internal_irq_state *state = &irq_states[cpu];
+
+	if (__atomic_sub_fetch(&state->soft_disabled, 1, __ATOMIC_RELAXED) != 0
+	    || !(flags & IRQ_FLAGS_ENABLED)) {
+		return;
+	}
+
+	if (__atomic_exchange_n(&state->pending, 0, __ATOMIC_RELAXED) != 0) {
+		irq_replay(cpu);
+	}
+}
+
+int irq_lazy_intercept() {
+	if (!irq_lazy) {
+		return 0;
+	}
+
+	struct internal_irq_state *state = &irq_states[percpu_id()];
+
+	if (__atomic_load_n(&state->soft_disabled, __ATOMIC_SEQ_CST) == 0) {
+		return 0;
+	}
+
+	__atomic_store_n(&state->pending, 1, __ATOMIC_SEQ_CST);
+
+	// NOTE: A migrated irq_save may have dropped its count from another
+	//       processor in the meantime. Either it sees pending and
+	//       replays, or the count is seen as 0 here and whoever clears
+	//       pending first delivers the interrupt
+	if (__atomic_load_n(&state->soft_disabled, __ATOMIC_SEQ_CST) == 0
+	    && __atomic_exchange_n(&state->pending, 0, __ATOMIC_SEQ_CST) != 0) {
+		return 0;
+	}
+
+	return 1;
+}
+
+int init_lazy_irq(ARC_IRQReplayFn replay) {
+	if (replay == NULL) {
+		return 1;
+	}
+
+	irq_replay = replay;
+	irq_lazy = true;
+
+	ARC_DEBUG(INFO, "Initialized lazy interrupt masking\n");
+
+	return 0;
+}
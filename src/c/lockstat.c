@@ -0,0 +1,130 @@
+/**
+ * @file lockstat.c
+ *
+ * @author awewsomegamer <awewsomegamer@gmail.com>
+ *
+ * @LICENSE
+ * Arctan-OS/Klib - Generic Kernel Functions and Data Structures
+ * Copyright (C) 2023-2026 awewsomegamer
+ *
+ * This file is part of Arctan-OS/Klib.
+ *
+ * Arctan-OS/Klib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * @DESCRIPTION
+*/
+#include "lib/lockstat.h"
+
+#ifdef ARC_LOCKSTAT
+
+#include "lib/schedhooks.h"
+#include "mp/scheduler.h"
+
+#include <stddef.h>
+
+ARC_LOCKSTAT_CLASS(lockstat_spinlock_class, "spinlock");
+ARC_LOCKSTAT_CLASS(lockstat_mutex_class, "mutex");
+ARC_LOCKSTAT_CLASS(lockstat_list_mutex_class, "list mutex");
+ARC_LOCKSTAT_CLASS(lockstat_ticket_class, "ticket lock");
+
+static ARC_LockClass *lockstat_head = NULL;
+
+uint64_t lockstat_now() {
+#ifdef ARC_TARGET_ARCH_X86_64
+	uint32_t low, high;
+	__asm__ volatile("rdtsc" : "=a"(low), "=d"(high));
+
+	return ((uint64_t)high << 32) | low;
+#else
+	return schedhooks_now();
+#endif
+}
+
+static inline int lockstat_bucket(uint64_t cycles) {
+	int bucket = cycles == 0 ? 0 : 64 - __builtin_clzll(cycles);
+
+	return bucket < ARC_LOCKSTAT_BUCKETS ? bucket : ARC_LOCKSTAT_BUCKETS - 1;
+}
+
+static ARC_LockClass *lockstat_class(ARC_LockStat *stat, ARC_LockClass *def) {
+	ARC_LockClass *class = stat->class != NULL ? stat->class : def;
+
+	// Link the class in the first time it is used
+	if (__atomic_load_n(&class->registered, __ATOMIC_ACQUIRE) == 0
+	    && __atomic_exchange_n(&class->registered, 1, __ATOMIC_ACQ_REL) == 0) {
+		ARC_LockClass *head = __atomic_load_n(&lockstat_head, __ATOMIC_RELAXED);
+
+		do {
+			class->next = head;
+		} while (!__atomic_compare_exchange_n(&lockstat_head, &head, class, 1, __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+	}
+
+	return class;
+}
+
+void lockstat_acquired(ARC_LockStat *stat, ARC_LockClass *def, uint64_t start, int contended) {
+	ARC_LockClass *class = lockstat_class(stat, def);
+	uint64_t now = lockstat_now();
+
+	__atomic_add_fetch(&class->acquisitions, 1, __ATOMIC_RELAXED);
+
+	if (contended) {
+		__atomic_add_fetch(&class->contentions, 1, __ATOMIC_RELAXED);
+	}
+
+	__atomic_add_fetch(&class->wait[lockstat_bucket(now - start)], 1, __ATOMIC_RELAXED);
+
+	stat->acquired = now;
+}
+
+void lockstat_released(ARC_LockStat *stat, ARC_LockClass *def) {
+	ARC_LockClass *class = lockstat_class(stat, def);
+	uint64_t held = lockstat_now() - stat->acquired;
+
+	__atomic_add_fetch(&class->hold[lockstat_bucket(held)], 1, __ATOMIC_RELAXED);
+
+	uint64_t max = __atomic_load_n(&class->max_hold, __ATOMIC_RELAXED);
+	while (held > max) {
+		if (__atomic_compare_exchange_n(&class->max_hold, &max, held, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+			// NOTE: Not updated together with max_hold, a racing
+			//       release may leave the other's thread here
+			__atomic_store_n(&class->max_holder, sched_current_thread(), __ATOMIC_RELAXED);
+			break;
+		}
+	}
+}
+
+ARC_LockClass *lockstat_classes() {
+	return __atomic_load_n(&lockstat_head, __ATOMIC_ACQUIRE);
+}
+
+int lockstat_reset(ARC_LockClass *class) {
+	if (class == NULL) {
+		return 1;
+	}
+
+	__atomic_store_n(&class->acquisitions, 0, __ATOMIC_RELAXED);
+	__atomic_store_n(&class->contentions, 0, __ATOMIC_RELAXED);
+	__atomic_store_n(&class->max_hold, 0, __ATOMIC_RELAXED);
+	__atomic_store_n(&class->max_holder, NULL, __ATOMIC_RELAXED);
+
+	for (int i = 0; i < ARC_LOCKSTAT_BUCKETS; i++) {
+		__atomic_store_n(&class->wait[i], 0, __ATOMIC_RELAXED);
+		__atomic_store_n(&class->hold[i], 0, __ATOMIC_RELAXED);
+	}
+
+	return 0;
+}
+
+#endif
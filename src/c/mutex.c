@@ -27,10 +27,18 @@
 #include "lib/mutex.h"
 #include "util.h"
 #include "lib/atomics.h"
+#include "lib/irq.h"
+#include "lib/park.h"
+#include "lib/schedhooks.h"
 #include "lib/util.h"
 #include "mm/allocator.h"
 #include "mp/scheduler.h"
 
+#define MUTEX_UNLOCKED  0
+#define MUTEX_LOCKED    1
+// Locked, and threads may be sleeping on the mutex
+#define MUTEX_CONTENDED 2
+
 int init_mutex(ARC_Mutex **mutex) {
 	if (mutex == NULL) {
 		return 1;
@@ -63,20 +71,93 @@ int init_static_mutex(ARC_Mutex *mutex) {
 	return 0;
 }
 
-int mutex_lock(ARC_Mutex *mutex) {
+static int mutex_park_validate(void *addr, void *arg) {
+	return __atomic_load_n(&((ARC_Mutex *)addr)->lock, __ATOMIC_RELAXED) == MUTEX_CONTENDED;
+}
+
+int mutex_trylock(ARC_Mutex *mutex) {
 	if (mutex == NULL) {
 		return 1;
 	}
 
-	while (__atomic_test_and_set(mutex, __ATOMIC_ACQUIRE)) {
-		// TODO: Would be good to do a bit of a hybrid so that
-		//       the core spins a little to see if it can lock it
-		//       before yielding to the thread that currently owns
-		//       the mutex
-		sched_yield(mutex->wake);
+	uint64_t expected = MUTEX_UNLOCKED;
+	if (!__atomic_compare_exchange_n(&mutex->lock, &expected, MUTEX_LOCKED, 0, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+		return -1;
 	}
 
 	mutex->wake = sched_current_thread();
+	ARC_LOCKSTAT_ACQUIRED(&mutex->lockstat, &lockstat_mutex_class, lockstat_now(), 0);
+
+	return 0;
+}
+
+static void mutex_sleep(ARC_Mutex *mutex) {
+	// Sleep, marking the mutex as contended so that the owner knows to
+	// wake a waiter. Once a thread has slept it keeps the mark when it
+	// gets the mutex, as there may be more sleepers behind it
+	while (__atomic_exchange_n(&mutex->lock, MUTEX_CONTENDED, __ATOMIC_ACQUIRE) != MUTEX_UNLOCKED) {
+		park_wait_cond(mutex, mutex_park_validate, NULL, 0);
+	}
+
+	mutex->wake = sched_current_thread();
+}
+
+int mutex_lock(ARC_Mutex *mutex) {
+	if (mutex == NULL) {
+		return 1;
+	}
+
+	if (mutex_trylock(mutex) == 0) {
+		return 0;
+	}
+
+	ARC_LOCKSTAT_START(start);
+
+	ARC_Thread *owner = NULL;
+	int spins = 0;
+
+	// While the owner is running on another processor it is likely to
+	// release the mutex soon, which is cheaper to wait for than a context
+	// switch. The budget starts over whenever ownership changes hands
+	while (spins < ARC_MUTEX_SPIN_MAX) {
+		ARC_Thread *current = __atomic_load_n(&mutex->wake, __ATOMIC_RELAXED);
+
+		if (current != owner) {
+			owner = current;
+			spins = 0;
+		}
+
+		if (!schedhooks_on_cpu(owner)) {
+			break;
+		}
+
+		uint64_t expected = MUTEX_UNLOCKED;
+		if (__atomic_load_n(&mutex->lock, __ATOMIC_RELAXED) == MUTEX_UNLOCKED
+		    && __atomic_compare_exchange_n(&mutex->lock, &expected, MUTEX_LOCKED, 0, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+			mutex->wake = sched_current_thread();
+			ARC_LOCKSTAT_ACQUIRED(&mutex->lockstat, &lockstat_mutex_class, start, 1);
+
+			return 0;
+		}
+
+		ARC_CPU_RELAX;
+		spins++;
+	}
+
+	mutex_sleep(mutex);
+	ARC_LOCKSTAT_ACQUIRED(&mutex->lockstat, &lockstat_mutex_class, start, 1);
+
+	return 0;
+}
+
+int mutex_lock_contended(ARC_Mutex *mutex) {
+	if (mutex == NULL) {
+		return 1;
+	}
+
+	ARC_LOCKSTAT_START(start);
+	mutex_sleep(mutex);
+	ARC_LOCKSTAT_ACQUIRED(&mutex->lockstat, &lockstat_mutex_class, start, 1);
 
 	return 0;
 }
@@ -86,7 +167,11 @@ int mutex_unlock(ARC_Mutex *mutex) {
 		return 1;
 	}
 
-	__atomic_clear(mutex, __ATOMIC_RELEASE);
+	ARC_LOCKSTAT_RELEASED(&mutex->lockstat, &lockstat_mutex_class);
+
+	if (__atomic_exchange_n(&mutex->lock, MUTEX_UNLOCKED, __ATOMIC_RELEASE) == MUTEX_CONTENDED) {
+		park_wake(mutex, 1);
+	}
 
 	return 0;
 }
@@ -130,45 +215,68 @@ int list_mutex_lock(ARC_ListMutex *mutex, ARC_ListMutexElement *elem) {
 		return 1;
 	}
 
-	// Save interrupt flag
-
-	ARC_DISABLE_INTERRUPT;
+	elem->next = NULL;
 	elem->wake = sched_current_thread();
+	elem->granted = 0;
+
+	ARC_LOCKSTAT_START(start);
+
+	// NOTE: Interrupts are kept off between joining the queue and
+	//       linking behind the previous element, as the previous owner
+	//       waits for the link to be made when it unlocks
+	ARC_IRQFlags flags = irq_save();
 	ARC_ListMutexElement *_elem = elem;
 	ARC_ListMutexElement *t = NULL;
 	ARC_ATOMIC_XCHG(&mutex->last, &_elem, &t);
-	if (t != NULL) {
-		t->next = elem;
-	} else {
+	if (t == NULL) {
 		mutex->current = elem;
-	}
-	ARC_ENABLE_INTERRUPT;
+		irq_restore(flags);
+		ARC_LOCKSTAT_ACQUIRED(&mutex->lockstat, &lockstat_list_mutex_class, start, 0);
 
-	while (mutex->current != elem) {
-		if (mutex->current == NULL) {
-			return -1;
-		}
+		return 0;
+	}
+	__atomic_store_n(&t->next, elem, __ATOMIC_RELEASE);
+	irq_restore(flags);
 
-		sched_yield(mutex->current->wake);
+	while (__atomic_load_n(&elem->granted, __ATOMIC_ACQUIRE) == 0) {
+		park_wait(&elem->granted, 0);
 	}
 
-	// Return interrupt flag to original state
+	ARC_LOCKSTAT_ACQUIRED(&mutex->lockstat, &lockstat_list_mutex_class, start, 1);
 
 	return 0;
 }
 
 int list_mutex_unlock(ARC_ListMutex *mutex) {
-	if (mutex == NULL) {
+	if (mutex == NULL || mutex->current == NULL) {
 		return 1;
 	}
 
-	// Save interrupt flag
-	ARC_DISABLE_INTERRUPT;
-	if (mutex->current != NULL) {
-		mutex->current = mutex->current->next;
+	ARC_LOCKSTAT_RELEASED(&mutex->lockstat, &lockstat_list_mutex_class);
+
+	ARC_ListMutexElement *owner = mutex->current;
+	ARC_ListMutexElement *next = __atomic_load_n(&owner->next, __ATOMIC_ACQUIRE);
+
+	if (next == NULL) {
+		// Nobody is queued, try to empty the queue. current is cleared
+		// first, as a locker which finds the queue empty sets it
+		mutex->current = NULL;
+
+		ARC_ListMutexElement *expected = owner;
+		if (__atomic_compare_exchange_n(&mutex->last, &expected, NULL, 0, __ATOMIC_RELEASE, __ATOMIC_RELAXED)) {
+			return 0;
+		}
+
+		// A locker has joined the queue, wait for it to link up
+		while ((next = __atomic_load_n(&owner->next, __ATOMIC_ACQUIRE)) == NULL) {
+			ARC_CPU_RELAX;
+		}
 	}
 
-	// Return interrupt flag to original state
+	// Hand the mutex over and wake only the new owner
+	mutex->current = next;
+	__atomic_store_n(&next->granted, 1, __ATOMIC_RELEASE);
+	park_wake(&next->granted, 1);
 
 	return 0;
 }
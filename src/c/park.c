@@ -0,0 +1,293 @@
+/**
+ * @file park.c
+ *
+ * @author awewsomegamer <awewsomegamer@gmail.com>
+ *
+ * @LICENSE
+ * Arctan-OS/Klib - Generic Kernel Functions and Data Structures
+ * Copyright (C) 2023-2026 awewsomegamer
+ *
+ * This file is part of Arctan-OS/Klib.
+ *
+ * Arctan-OS/Klib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * @DESCRIPTION
+*/
+#include "lib/park.h"
+#include "lib/atomics.h"
+#include "lib/schedhooks.h"
+#include "lib/spinlock.h"
+#include "mp/scheduler.h"
+
+#include <stddef.h>
+
+#define PARK_WAITING 0
+// A waker has dequeued the waiter but may still be using it
+#define PARK_CLAIMED 1
+#define PARK_WOKEN   2
+
+struct internal_park_waiter {
+	void *addr;
+	ARC_Thread *thread;
+	uint32_t woken;
+	struct internal_park_waiter *next;
+	struct internal_park_waiter *prev;
+};
+
+struct internal_park_bucket {
+	ARC_Spinlock lock;
+	struct internal_park_waiter *head;
+	struct internal_park_waiter *tail;
+} __attribute__((aligned(ARC_CACHE_LINE)));
+
+static struct internal_park_bucket park_buckets[ARC_PARK_BUCKETS] = { 0 };
+
+static struct internal_park_bucket *park_bucket(void *addr) {
+	// Fibonacci hashing, the low bits of addresses carry little
+	uint64_t hash = ((uintptr_t)addr >> 3) * 0x9E3779B97F4A7C15;
+
+	return &park_buckets[(hash >> 32) & (ARC_PARK_BUCKETS - 1)];
+}
+
+static void park_unlink(struct internal_park_bucket *bucket, struct internal_park_waiter *waiter) {
+	if (waiter->prev != NULL) {
+		waiter->prev->next = waiter->next;
+	} else {
+		bucket->head = waiter->next;
+	}
+
+	if (waiter->next != NULL) {
+		waiter->next->prev = waiter->prev;
+	} else {
+		bucket->tail = waiter->prev;
+	}
+}
+
+static void park_append(struct internal_park_bucket *bucket, struct internal_park_waiter *waiter) {
+	waiter->next = NULL;
+	waiter->prev = bucket->tail;
+
+	if (bucket->tail != NULL) {
+		bucket->tail->next = waiter;
+	} else {
+		bucket->head = waiter;
+	}
+
+	bucket->tail = waiter;
+}
+
+// Lock the bucket a waiter is queued in. park_requeue may move the
+// waiter to another bucket, but only with both buckets locked
+static struct internal_park_bucket *park_lock_waiter(struct internal_park_waiter *waiter, ARC_IRQFlags *flags) {
+	for (;;) {
+		struct internal_park_bucket *bucket = park_bucket(__atomic_load_n(&waiter->addr, __ATOMIC_RELAXED));
+		spinlock_lock_irqsave(&bucket->lock, flags);
+
+		if (park_bucket(waiter->addr) == bucket) {
+			return bucket;
+		}
+
+		spinlock_unlock_irqrestore(&bucket->lock, *flags);
+	}
+}
+
+// NOTE: A waiter which times out checks woken with its bucket locked,
+//       so dequeued waiters must be claimed before the lock is dropped
+static void park_claim(struct internal_park_waiter *woken) {
+	while (woken != NULL) {
+		__atomic_store_n(&woken->woken, PARK_CLAIMED, __ATOMIC_RELAXED);
+		woken = woken->next;
+	}
+}
+
+// Wake claimed waiters, with no bucket locked
+static void park_wake_claimed(struct internal_park_waiter *woken) {
+	// The waiter may return as soon as it sees PARK_WOKEN, after which
+	// it must not be touched
+	while (woken != NULL) {
+		struct internal_park_waiter *next = woken->next;
+		ARC_Thread *thread = woken->thread;
+
+		__atomic_store_n(&woken->woken, PARK_WOKEN, __ATOMIC_RELEASE);
+		schedhooks_unblock(thread);
+
+		woken = next;
+	}
+}
+
+static int park_validate_value(void *addr, void *arg) {
+	return __atomic_load_n((uint64_t *)addr, __ATOMIC_RELAXED) == *(uint64_t *)arg;
+}
+
+int park_wait_cond(void *addr, ARC_ParkValidate validate, void *arg, uint64_t deadline) {
+	if (addr == NULL || validate == NULL) {
+		return 1;
+	}
+
+	struct internal_park_bucket *bucket = park_bucket(addr);
+	struct internal_park_waiter waiter = {
+		.addr = addr,
+		.thread = sched_current_thread(),
+		.woken = PARK_WAITING,
+		.next = NULL,
+	};
+
+	ARC_IRQFlags flags;
+	spinlock_lock_irqsave(&bucket->lock, &flags);
+
+	if (!validate(addr, arg)) {
+		spinlock_unlock_irqrestore(&bucket->lock, flags);
+		return -1;
+	}
+
+	park_append(bucket, &waiter);
+
+	spinlock_unlock_irqrestore(&bucket->lock, flags);
+
+	while (__atomic_load_n(&waiter.woken, __ATOMIC_ACQUIRE) != PARK_WOKEN) {
+		schedhooks_block(deadline);
+
+		if (deadline == 0 || __atomic_load_n(&waiter.woken, __ATOMIC_ACQUIRE) != PARK_WAITING
+		    || schedhooks_now() < deadline) {
+			continue;
+		}
+
+		// Timed out, but a waker may have dequeued this waiter in
+		// the meantime, in which case the wake is taken instead
+		bucket = park_lock_waiter(&waiter, &flags);
+
+		if (__atomic_load_n(&waiter.woken, __ATOMIC_ACQUIRE) == PARK_WAITING) {
+			park_unlink(bucket, &waiter);
+			spinlock_unlock_irqrestore(&bucket->lock, flags);
+
+			return -2;
+		}
+
+		spinlock_unlock_irqrestore(&bucket->lock, flags);
+	}
+
+	return 0;
+}
+
+int park_wait_timeout(uint64_t *addr, uint64_t expected, uint64_t deadline) {
+	return park_wait_cond(addr, park_validate_value, &expected, deadline);
+}
+
+int park_wait(uint64_t *addr, uint64_t expected) {
+	return park_wait_cond(addr, park_validate_value, &expected, 0);
+}
+
+int park_wake(void *addr, int n) {
+	if (addr == NULL || n <= 0) {
+		return 0;
+	}
+
+	struct internal_park_bucket *bucket = park_bucket(addr);
+	// Kept in the order the waiters parked in
+	struct internal_park_waiter *woken = NULL;
+	struct internal_park_waiter **woken_tail = &woken;
+	int count = 0;
+
+	ARC_IRQFlags flags;
+	spinlock_lock_irqsave(&bucket->lock, &flags);
+
+	struct internal_park_waiter *current = bucket->head;
+	while (current != NULL && count < n) {
+		struct internal_park_waiter *next = current->next;
+
+		if (current->addr == addr) {
+			park_unlink(bucket, current);
+			current->next = NULL;
+			*woken_tail = current;
+			woken_tail = &current->next;
+			count++;
+		}
+
+		current = next;
+	}
+
+	park_claim(woken);
+	spinlock_unlock_irqrestore(&bucket->lock, flags);
+	park_wake_claimed(woken);
+
+	return count;
+}
+
+int park_requeue(void *from, void *to, int n_wake, int n_requeue) {
+	if (from == NULL || to == NULL || n_wake < 0 || n_requeue < 0) {
+		return -1;
+	}
+
+	struct internal_park_bucket *bucket = park_bucket(from);
+	struct internal_park_bucket *target = park_bucket(to);
+	struct internal_park_waiter *woken = NULL;
+	struct internal_park_waiter **woken_tail = &woken;
+	int count = 0;
+	int moved = 0;
+
+	// Lock both buckets, always in the same order
+	ARC_IRQFlags flags;
+	ARC_IRQFlags target_flags;
+	if (bucket < target) {
+		spinlock_lock_irqsave(&bucket->lock, &flags);
+		spinlock_lock_irqsave(&target->lock, &target_flags);
+	} else if (bucket > target) {
+		spinlock_lock_irqsave(&target->lock, &target_flags);
+		spinlock_lock_irqsave(&bucket->lock, &flags);
+	} else {
+		spinlock_lock_irqsave(&bucket->lock, &flags);
+	}
+
+	struct internal_park_waiter *current = bucket->head;
+	while (current != NULL && (count < n_wake || moved < n_requeue)) {
+		struct internal_park_waiter *next = current->next;
+
+		if (current->addr != from) {
+			current = next;
+			continue;
+		}
+
+		park_unlink(bucket, current);
+
+		if (count < n_wake) {
+			current->next = NULL;
+			*woken_tail = current;
+			woken_tail = &current->next;
+			count++;
+		} else {
+			__atomic_store_n(&current->addr, to, __ATOMIC_RELAXED);
+			park_append(target, current);
+			moved++;
+		}
+
+		current = next;
+	}
+
+	park_claim(woken);
+
+	// Restore the interrupt state saved by the second lock first
+	if (bucket < target) {
+		spinlock_unlock_irqrestore(&target->lock, target_flags);
+		spinlock_unlock_irqrestore(&bucket->lock, flags);
+	} else if (bucket > target) {
+		spinlock_unlock_irqrestore(&bucket->lock, flags);
+		spinlock_unlock_irqrestore(&target->lock, target_flags);
+	} else {
+		spinlock_unlock_irqrestore(&bucket->lock, flags);
+	}
+
+	park_wake_claimed(woken);
+
+	return count + moved;
+}
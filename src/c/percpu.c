@@ -0,0 +1,101 @@
+/**
+ * @file percpu.c
+ *
+ * @author awewsomegamer <awewsomegamer@gmail.com>
+ *
+ * @LICENSE
+ * Arctan-OS/Klib - Generic Kernel Functions and Data Structures
+ * Copyright (C) 2023-2026 awewsomegamer
+ *
+ * This file is part of Arctan-OS/Klib.
+ *
+ * Arctan-OS/Klib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * @DESCRIPTION
+*/
+#include <lib/percpu.h>
+#include <global.h>
+
+static ARC_PercpuIDFn percpu_get_id = NULL;
+static ARC_PercpuIDFn percpu_get_node = NULL;
+static uint32_t percpu_count = 1;
+static uint32_t percpu_node_count = 1;
+
+uint32_t percpu_id() {
+	if (percpu_get_id == NULL) {
+		return 0;
+	}
+
+	uint32_t id = percpu_get_id();
+
+	// NOTE: Folding the ID back into range would let two processors
+	//       share per-CPU state that is updated without atomics
+	if (id >= percpu_count) {
+		ARC_DEBUG(ERR, "Processor ID %d out of range (%d processors)\n", id, percpu_count);
+		ARC_HANG;
+	}
+
+	return id;
+}
+
+int init_percpu(ARC_PercpuIDFn get_id, uint32_t count) {
+	if (get_id == NULL || count == 0) {
+		return 1;
+	}
+
+	if (count > ARC_PERCPU_MAX) {
+		ARC_DEBUG(ERR, "%d processors, but per-CPU state only covers %d\n", count, ARC_PERCPU_MAX);
+		return 1;
+	}
+
+	percpu_count = count;
+	percpu_get_id = get_id;
+
+	ARC_DEBUG(INFO, "Initialized per-CPU identification\n");
+
+	return 0;
+}
+
+uint32_t percpu_node() {
+	if (percpu_get_node == NULL) {
+		return 0;
+	}
+
+	uint32_t node = percpu_get_node();
+
+	if (node >= percpu_node_count) {
+		ARC_DEBUG(ERR, "Node ID %d out of range (%d nodes)\n", node, percpu_node_count);
+		ARC_HANG;
+	}
+
+	return node;
+}
+
+int init_percpu_nodes(ARC_PercpuIDFn get_node, uint32_t count) {
+	if (get_node == NULL || count == 0) {
+		return 1;
+	}
+
+	if (count > ARC_PERCPU_NODES_MAX) {
+		ARC_DEBUG(ERR, "%d nodes, but per-node state only covers %d\n", count, ARC_PERCPU_NODES_MAX);
+		return 1;
+	}
+
+	percpu_node_count = count;
+	percpu_get_node = get_node;
+
+	ARC_DEBUG(INFO, "Initialized per-CPU node identification\n");
+
+	return 0;
+}
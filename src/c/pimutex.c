@@ -0,0 +1,351 @@
+/**
+ * @file pimutex.c
+ *
+ * @author awewsomegamer <awewsomegamer@gmail.com>
+ *
+ * @LICENSE
+ * Arctan-OS/Klib - Generic Kernel Functions and Data Structures
+ * Copyright (C) 2023-2026 awewsomegamer
+ *
+ * This file is part of Arctan-OS/Klib.
+ *
+ * Arctan-OS/Klib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * @DESCRIPTION
+*/
+#include "lib/pimutex.h"
+#include "lib/atomics.h"
+#include "lib/park.h"
+#include "lib/schedhooks.h"
+#include "lib/spinlock.h"
+#include "lib/util.h"
+#include "mm/allocator.h"
+#include "mp/scheduler.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#define PIMUTEX_WAITERS 1
+
+struct internal_pi_waiter {
+	struct internal_pi_waiter *next;
+	ARC_Thread *thread;
+	int prio;
+	ARC_PIMutex *mutex;
+	uint64_t granted;
+};
+
+// NOTE: All PI bookkeeping is done under one lock. Only contended lock and
+//       unlock operations take it, and they are about to sleep or wake a
+//       thread anyway
+static ARC_Spinlock pi_lock = { 0 };
+
+static inline ARC_Thread *pimutex_owner(ARC_PIMutex *mutex) {
+	return (ARC_Thread *)(__atomic_load_n(&mutex->owner, __ATOMIC_RELAXED) & ~(uint64_t)PIMUTEX_WAITERS);
+}
+
+// Get the PI state of a thread, taking it into use if it was not. NULL
+// without the pi_state hook, in which case no one is boosted
+static ARC_PIState *pi_task_get(ARC_Thread *thread) {
+	ARC_PIState *task = schedhooks_pi_state(thread);
+
+	if (task == NULL || task->active) {
+		return task;
+	}
+
+	task->active = 1;
+	task->base = schedhooks_get_priority(thread);
+	task->prio = task->base;
+	task->held = NULL;
+	task->blocked = NULL;
+
+	return task;
+}
+
+// Stop using the state of a thread which no longer holds or waits on
+// anything, dropping any boost it had left
+static void pi_task_put(ARC_Thread *thread, ARC_PIState *task) {
+	if (task == NULL || task->held != NULL || task->blocked != NULL) {
+		return;
+	}
+
+	if (task->prio != task->base) {
+		schedhooks_set_priority(thread, task->base);
+	}
+
+	task->active = 0;
+}
+
+static void pi_queue_insert(ARC_PIMutex *mutex, struct internal_pi_waiter *waiter) {
+	struct internal_pi_waiter **slot = (struct internal_pi_waiter **)&mutex->waiters;
+
+	// Most urgent first, in arrival order among equals
+	while (*slot != NULL && (*slot)->prio >= waiter->prio) {
+		slot = &(*slot)->next;
+	}
+
+	waiter->next = *slot;
+	*slot = waiter;
+}
+
+static void pi_queue_remove(ARC_PIMutex *mutex, struct internal_pi_waiter *waiter) {
+	struct internal_pi_waiter **slot = (struct internal_pi_waiter **)&mutex->waiters;
+
+	while (*slot != NULL && *slot != waiter) {
+		slot = &(*slot)->next;
+	}
+
+	if (*slot != NULL) {
+		*slot = waiter->next;
+	}
+}
+
+static void pi_held_remove(ARC_PIState *task, ARC_PIMutex *mutex) {
+	if (task == NULL) {
+		return;
+	}
+
+	ARC_PIMutex **slot = &task->held;
+
+	while (*slot != NULL && *slot != mutex) {
+		slot = &(*slot)->next_held;
+	}
+
+	if (*slot != NULL) {
+		*slot = mutex->next_held;
+	}
+
+	mutex->next_held = NULL;
+}
+
+static void pi_held_add(ARC_PIState *task, ARC_PIMutex *mutex) {
+	if (task == NULL) {
+		return;
+	}
+
+	for (ARC_PIMutex *current = task->held; current != NULL; current = current->next_held) {
+		if (current == mutex) {
+			return;
+		}
+	}
+
+	mutex->next_held = task->held;
+	task->held = mutex;
+}
+
+// Bring the priority of a task in line with its waiters, and pass the
+// change on along the chain of owners it is blocked behind
+static void pi_adjust(ARC_Thread *thread, ARC_PIState *task) {
+	for (int depth = 0; task != NULL && depth < ARC_PIMUTEX_MAX_CHAIN; depth++) {
+		int prio = task->base;
+
+		for (ARC_PIMutex *mutex = task->held; mutex != NULL; mutex = mutex->next_held) {
+			struct internal_pi_waiter *top = mutex->waiters;
+
+			if (top != NULL && top->prio > prio) {
+				prio = top->prio;
+			}
+		}
+
+		if (prio == task->prio) {
+			return;
+		}
+
+		task->prio = prio;
+		schedhooks_set_priority(thread, prio);
+
+		struct internal_pi_waiter *waiter = task->blocked;
+
+		if (waiter == NULL) {
+			return;
+		}
+
+		// Move the task to its new place in the queue it waits in
+		pi_queue_remove(waiter->mutex, waiter);
+		waiter->prio = prio;
+		pi_queue_insert(waiter->mutex, waiter);
+
+		thread = pimutex_owner(waiter->mutex);
+		task = pi_task_get(thread);
+	}
+}
+
+int init_pimutex(ARC_PIMutex **mutex) {
+	if (mutex == NULL) {
+		return 1;
+	}
+
+	*mutex = (ARC_PIMutex *)alloc(sizeof(**mutex));
+
+	if (*mutex == NULL) {
+		return 1;
+	}
+
+	memset(*mutex, 0, sizeof(**mutex));
+
+	return 0;
+}
+
+int uninit_pimutex(ARC_PIMutex *mutex) {
+	free(mutex);
+
+	return 0;
+}
+
+int init_static_pimutex(ARC_PIMutex *mutex) {
+	if (mutex == NULL) {
+		return 1;
+	}
+
+	memset(mutex, 0, sizeof(*mutex));
+
+	return 0;
+}
+
+int pimutex_trylock(ARC_PIMutex *mutex) {
+	if (mutex == NULL) {
+		return 1;
+	}
+
+	uint64_t expected = 0;
+	uint64_t self = (uintptr_t)sched_current_thread();
+
+	if (!__atomic_compare_exchange_n(&mutex->owner, &expected, self, 0, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+		return -1;
+	}
+
+	return 0;
+}
+
+int pimutex_lock(ARC_PIMutex *mutex) {
+	if (mutex == NULL) {
+		return 1;
+	}
+
+	if (pimutex_trylock(mutex) == 0) {
+		return 0;
+	}
+
+	ARC_Thread *self = sched_current_thread();
+	struct internal_pi_waiter waiter = { .thread = self, .mutex = mutex, .granted = 0 };
+
+	ARC_IRQFlags flags;
+	spinlock_lock_irqsave(&pi_lock, &flags);
+
+	// Set the waiters bit, so that the owner takes the slow path to unlock
+	uint64_t owner = __atomic_load_n(&mutex->owner, __ATOMIC_RELAXED);
+	for (;;) {
+		uint64_t desired = owner | PIMUTEX_WAITERS;
+
+		if (owner == 0) {
+			// Released in the meantime (no one is queued, as the mutex
+			// is handed to a waiter directly)
+			desired = (uintptr_t)self;
+		}
+
+		if (__atomic_compare_exchange_n(&mutex->owner, &owner, desired, 0, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+			break;
+		}
+	}
+
+	if (owner == 0) {
+		spinlock_unlock_irqrestore(&pi_lock, flags);
+
+		return 0;
+	}
+
+	ARC_PIState *task = pi_task_get(self);
+	ARC_PIState *owner_task = pi_task_get(pimutex_owner(mutex));
+
+	pi_held_add(owner_task, mutex);
+
+	waiter.prio = task != NULL ? task->prio : schedhooks_get_priority(self);
+	pi_queue_insert(mutex, &waiter);
+
+	if (task != NULL) {
+		task->blocked = &waiter;
+	}
+
+	pi_adjust(pimutex_owner(mutex), owner_task);
+
+	spinlock_unlock_irqrestore(&pi_lock, flags);
+
+	while (__atomic_load_n(&waiter.granted, __ATOMIC_ACQUIRE) == 0) {
+		park_wait(&waiter.granted, 0);
+	}
+
+	return 0;
+}
+
+int pimutex_unlock(ARC_PIMutex *mutex) {
+	if (mutex == NULL) {
+		return 1;
+	}
+
+	ARC_Thread *self = sched_current_thread();
+	uint64_t expected = (uintptr_t)self;
+
+	if (__atomic_compare_exchange_n(&mutex->owner, &expected, 0, 0, __ATOMIC_RELEASE, __ATOMIC_RELAXED)) {
+		return 0;
+	}
+
+	ARC_IRQFlags flags;
+	spinlock_lock_irqsave(&pi_lock, &flags);
+
+	// The fast path also fails if the caller does not own the mutex
+	if (pimutex_owner(mutex) != self || mutex->waiters == NULL) {
+		spinlock_unlock_irqrestore(&pi_lock, flags);
+		return 1;
+	}
+
+	ARC_PIState *task = pi_task_get(self);
+	struct internal_pi_waiter *waiter = mutex->waiters;
+
+	mutex->waiters = waiter->next;
+	pi_held_remove(task, mutex);
+
+	// Hand the mutex to the most urgent waiter, which takes over the
+	// boost from the waiters behind it
+	ARC_PIState *next = pi_task_get(waiter->thread);
+
+	if (next != NULL) {
+		next->blocked = NULL;
+	}
+
+	uint64_t owner = (uintptr_t)waiter->thread;
+	if (mutex->waiters != NULL) {
+		owner |= PIMUTEX_WAITERS;
+		pi_held_add(next, mutex);
+	}
+
+	__atomic_store_n(&mutex->owner, owner, __ATOMIC_RELEASE);
+
+	pi_adjust(waiter->thread, next);
+	pi_task_put(waiter->thread, next);
+
+	__atomic_store_n(&waiter->granted, 1, __ATOMIC_RELEASE);
+
+	// NOTE: The new owner is woken before the caller's boost is dropped.
+	//       Dropping it first lets a thread of medium priority preempt
+	//       the caller before the wake, keeping the new owner waiting
+	//       behind it
+	park_wake(&waiter->granted, 1);
+
+	pi_adjust(self, task);
+	pi_task_put(self, task);
+
+	spinlock_unlock_irqrestore(&pi_lock, flags);
+
+	return 0;
+}
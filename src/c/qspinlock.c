@@ -0,0 +1,219 @@
+/**
+ * @file qspinlock.c
+ *
+ * @author awewsomegamer <awewsomegamer@gmail.com>
+ *
+ * @LICENSE
+ * Arctan-OS/Klib - Generic Kernel Functions and Data Structures
+ * Copyright (C) 2023-2026 awewsomegamer
+ *
+ * This file is part of Arctan-OS/Klib.
+ *
+ * Arctan-OS/Klib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * @DESCRIPTION
+*/
+#include "lib/qspinlock.h"
+#include "lib/atomics.h"
+#include "lib/irq.h"
+#include "lib/percpu.h"
+#include "lib/util.h"
+#include "mm/allocator.h"
+
+#define QSPINLOCK_LOCKED      0xFF
+#define QSPINLOCK_LOCKED_MASK 0xFF
+#define QSPINLOCK_TAIL_SHIFT  16
+#define QSPINLOCK_TAIL_MASK   (0xFFFFU << QSPINLOCK_TAIL_SHIFT)
+#define QSPINLOCK_IDX_BITS    2
+// Number of nodes per processor, one for each context (thread, IRQ,
+// NMI, ...) which may be spinning on a queued lock at the same time
+#define QSPINLOCK_NESTING     (1 << QSPINLOCK_IDX_BITS)
+
+struct internal_qspinlock_node {
+	struct internal_qspinlock_node *next;
+	uint32_t locked;
+	// Only used in the first node of each processor, number of
+	// nodes currently in use on the processor
+	uint32_t count;
+} __attribute__((aligned(ARC_CACHE_LINE)));
+
+static struct internal_qspinlock_node qspinlock_nodes[ARC_PERCPU_MAX][QSPINLOCK_NESTING];
+
+static inline uint32_t qspinlock_encode_tail(uint32_t cpu, uint32_t idx) {
+	return (((cpu + 1) << QSPINLOCK_IDX_BITS) | idx) << QSPINLOCK_TAIL_SHIFT;
+}
+
+static inline struct internal_qspinlock_node *qspinlock_decode_tail(uint32_t tail) {
+	tail >>= QSPINLOCK_TAIL_SHIFT;
+
+	uint32_t cpu = (tail >> QSPINLOCK_IDX_BITS) - 1;
+	uint32_t idx = tail & (QSPINLOCK_NESTING - 1);
+
+	return &qspinlock_nodes[cpu][idx];
+}
+
+static inline int qspinlock_try(ARC_QSpinlock *lock) {
+	uint32_t expected = 0;
+	return __atomic_compare_exchange_n(&lock->val, &expected, QSPINLOCK_LOCKED, 0, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED);
+}
+
+// NOTE: Must be called with interrupts disabled, so that the calling
+//       processor and the node it picks stay the same throughout
+static void qspinlock_lock_slow(ARC_QSpinlock *lock) {
+	uint32_t cpu = percpu_id();
+	struct internal_qspinlock_node *node = &qspinlock_nodes[cpu][0];
+	uint32_t idx = node->count++;
+
+	if (idx >= QSPINLOCK_NESTING) {
+		// Out of nodes, fall back to spinning on the lock word
+		while (!qspinlock_try(lock)) {
+			ARC_CPU_RELAX;
+		}
+
+		goto release;
+	}
+
+	node += idx;
+	node->next = NULL;
+	node->locked = 0;
+
+	// The lock may have been released while the node was set up
+	if (qspinlock_try(lock)) {
+		goto release;
+	}
+
+	// Publish this node as the new tail, leaving the locked byte alone
+	uint32_t tail = qspinlock_encode_tail(cpu, idx);
+	uint32_t old = __atomic_load_n(&lock->val, __ATOMIC_RELAXED);
+	while (!__atomic_compare_exchange_n(&lock->val, &old, (old & ~QSPINLOCK_TAIL_MASK) | tail, 0,
+					    __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)) {
+		ARC_CPU_RELAX;
+	}
+
+	if ((old & QSPINLOCK_TAIL_MASK) != 0) {
+		// Link behind the previous tail and wait to become the head
+		struct internal_qspinlock_node *prev = qspinlock_decode_tail(old);
+		__atomic_store_n(&prev->next, node, __ATOMIC_RELEASE);
+
+		while (!__atomic_load_n(&node->locked, __ATOMIC_ACQUIRE)) {
+			ARC_CPU_RELAX;
+		}
+	}
+
+	// Head of the queue, only this node may take the lock from here on
+	uint32_t val = 0;
+	while ((val = __atomic_load_n(&lock->val, __ATOMIC_ACQUIRE)) & QSPINLOCK_LOCKED_MASK) {
+		ARC_CPU_RELAX;
+	}
+
+	if ((val & QSPINLOCK_TAIL_MASK) == tail
+	    && __atomic_compare_exchange_n(&lock->val, &val, QSPINLOCK_LOCKED, 0, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+		// Last in the queue, the queue is now empty
+		goto release;
+	}
+
+	__atomic_fetch_or(&lock->val, QSPINLOCK_LOCKED, __ATOMIC_ACQUIRE);
+
+	// Someone has queued up behind this node, wait for them to finish
+	// linking and make them the new head
+	struct internal_qspinlock_node *next = NULL;
+	while ((next = __atomic_load_n(&node->next, __ATOMIC_ACQUIRE)) == NULL) {
+		ARC_CPU_RELAX;
+	}
+
+	__atomic_store_n(&next->locked, 1, __ATOMIC_RELEASE);
+
+	release:;
+	qspinlock_nodes[cpu][0].count--;
+}
+
+int init_qspinlock(ARC_QSpinlock **lock) {
+	if (lock == NULL) {
+		return 1;
+	}
+
+	*lock = (ARC_QSpinlock *)alloc(sizeof(**lock));
+
+	if (*lock == NULL) {
+		return 1;
+	}
+
+	memset(*lock, 0, sizeof(**lock));
+
+	return 0;
+}
+
+int uninit_qspinlock(ARC_QSpinlock *lock) {
+	free(lock);
+
+	return 0;
+}
+
+int init_static_qspinlock(ARC_QSpinlock *lock) {
+	if (lock == NULL) {
+		return 1;
+	}
+
+	memset(lock, 0, sizeof(*lock));
+
+	return 0;
+}
+
+int qspinlock_lock(ARC_QSpinlock *lock) {
+	if (lock == NULL) {
+		return 1;
+	}
+
+	ARC_IRQFlags interrupts = irq_save();
+
+	if (!qspinlock_try(lock)) {
+		qspinlock_lock_slow(lock);
+	}
+
+	lock->interrupts = interrupts;
+
+	return 0;
+}
+
+int qspinlock_trylock(ARC_QSpinlock *lock) {
+	if (lock == NULL) {
+		return 1;
+	}
+
+	ARC_IRQFlags interrupts = irq_save();
+
+	if (!qspinlock_try(lock)) {
+		irq_restore(interrupts);
+
+		return -1;
+	}
+
+	lock->interrupts = interrupts;
+
+	return 0;
+}
+
+int qspinlock_unlock(ARC_QSpinlock *lock) {
+	if (lock == NULL) {
+		return 1;
+	}
+
+	ARC_IRQFlags interrupts = lock->interrupts;
+
+	__atomic_fetch_and(&lock->val, ~QSPINLOCK_LOCKED_MASK, __ATOMIC_RELEASE);
+
+	irq_restore(interrupts);
+
+	return 0;
+}
@@ -0,0 +1,187 @@
+/**
+ * @file recordring.c
+ *
+ * @author awewsomegamer <awewsomegamer@gmail.com>
+ *
+ * @LICENSE
+ * Arctan-OS/Klib - Generic Kernel Functions and Data Structures
+ * Copyright (C) 2023-2026 awewsomegamer
+ *
+ * This file is part of Arctan-OS/Klib.
+ *
+ * Arctan-OS/Klib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * @DESCRIPTION
+*/
+#include <lib/recordring.h>
+#include <lib/util.h>
+#include <mm/allocator.h>
+#include <global.h>
+
+#define RECORD_PADDING 1
+#define RECORD_BUSY     2
+
+struct internal_record_header {
+	uint32_t length;
+	uint32_t flags;
+};
+
+#define RECORD_ALIGN(__length) (((__length) + 7) & ~(size_t)7)
+
+static inline struct internal_record_header *record_header(ARC_RecordRing *ring, size_t pos) {
+	return (struct internal_record_header *)(ring->base + (pos & ring->mask));
+}
+
+int record_ring_reserve(ARC_RecordRing *ring, size_t length, ARC_Record *record) {
+	if (ring == NULL || record == NULL || length > UINT32_MAX) {
+		return 1;
+	}
+
+	size_t total = RECORD_ALIGN(sizeof(struct internal_record_header) + length);
+
+	// NOTE: Bigger records could need more than the whole buffer once
+	//       padded, and might never fit
+	if (total > ring->size / 2) {
+		return 1;
+	}
+
+	// NOTE: The lock only covers finding the space and writing the
+	//       headers, interrupts are disabled so that a handler
+	//       reserving on the same processor cannot spin on it
+	ARC_IRQFlags flags = 0;
+	spinlock_lock_irqsave(&ring->producer.lock, &flags);
+
+	size_t pos = ring->producer.head;
+	size_t offset = pos & ring->mask;
+	size_t pad = offset + total > ring->size ? ring->size - offset : 0;
+	size_t tail = __atomic_load_n(&ring->consumer.tail, __ATOMIC_ACQUIRE);
+
+	if (pos + pad + total - tail > ring->size) {
+		spinlock_unlock_irqrestore(&ring->producer.lock, flags);
+		return -2;
+	}
+
+	if (pad != 0) {
+		struct internal_record_header *header = record_header(ring, pos);
+		header->length = pad - sizeof(*header);
+		__atomic_store_n(&header->flags, RECORD_PADDING, __ATOMIC_RELAXED);
+	}
+
+	struct internal_record_header *header = record_header(ring, pos + pad);
+	header->length = length;
+	__atomic_store_n(&header->flags, RECORD_BUSY, __ATOMIC_RELAXED);
+
+	// Publish the headers along with the space
+	__atomic_store_n(&ring->producer.head, pos + pad + total, __ATOMIC_RELEASE);
+
+	spinlock_unlock_irqrestore(&ring->producer.lock, flags);
+
+	record->data = (void *)(header + 1);
+	record->length = length;
+	record->pos = pos;
+	record->total = pad + total;
+
+	return 0;
+}
+
+int record_ring_commit(ARC_RecordRing *ring, ARC_Record *record) {
+	if (ring == NULL || record == NULL) {
+		return 1;
+	}
+
+	struct internal_record_header *header = (struct internal_record_header *)record->data - 1;
+	__atomic_store_n(&header->flags, 0, __ATOMIC_RELEASE);
+
+	return 0;
+}
+
+int record_ring_peek(ARC_RecordRing *ring, ARC_Record *record) {
+	if (ring == NULL || record == NULL) {
+		return 1;
+	}
+
+	size_t tail = ring->consumer.tail;
+	size_t head = __atomic_load_n(&ring->producer.head, __ATOMIC_ACQUIRE);
+
+	for (;;) {
+		if (tail == head) {
+			return -2;
+		}
+
+		struct internal_record_header *header = record_header(ring, tail);
+		uint32_t flags = __atomic_load_n(&header->flags, __ATOMIC_ACQUIRE);
+
+		// Reserved, but not committed yet
+		if (flags & RECORD_BUSY) {
+			return -2;
+		}
+
+		if (flags & RECORD_PADDING) {
+			// Give the padding back to producers straight away
+			tail += sizeof(*header) + header->length;
+			__atomic_store_n(&ring->consumer.tail, tail, __ATOMIC_RELEASE);
+			continue;
+		}
+
+		record->data = (void *)(header + 1);
+		record->length = header->length;
+		record->pos = tail;
+		record->total = RECORD_ALIGN(sizeof(*header) + header->length);
+
+		return 0;
+	}
+}
+
+int record_ring_consume(ARC_RecordRing *ring, ARC_Record *record) {
+	if (ring == NULL || record == NULL) {
+		return 1;
+	}
+
+	__atomic_store_n(&ring->consumer.tail, record->pos + record->total, __ATOMIC_RELEASE);
+
+	return 0;
+}
+
+ARC_RecordRing *init_record_ring(void *base, size_t size) {
+	if (base == NULL || size < sizeof(struct internal_record_header) || (size & (size - 1)) != 0 || ((uintptr_t)base & 7) != 0) {
+		return NULL;
+	}
+
+	ARC_RecordRing *ring = (ARC_RecordRing *)alloc(sizeof(*ring));
+
+	if (ring == NULL) {
+		return NULL;
+	}
+
+	memset(ring, 0, sizeof(*ring));
+
+	ring->base = base;
+	ring->size = size;
+	ring->mask = size - 1;
+	init_static_spinlock(&ring->producer.lock);
+
+	ARC_DEBUG(INFO, "Created record ring at %p (%lu bytes)\n", ring->base, ring->size);
+
+	return ring;
+}
+
+int uninit_record_ring(ARC_RecordRing *ring) {
+	if (ring == NULL) {
+		return 1;
+	}
+
+	free(ring);
+
+	return 0;
+}
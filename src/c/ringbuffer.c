@@ -25,10 +25,14 @@
  * @DESCRIPTION
 */
 #include <lib/ringbuffer.h>
+#include <lib/park.h>
+#include <lib/schedhooks.h>
 #include <lib/util.h>
 #include <mm/allocator.h>
 #include <global.h>
 
+static ARC_RingbufferVMHooks ringbuffer_vm = { 0 };
+
 size_t ringbuffer_allocate(ARC_Ringbuffer *ringbuffer, int block) {
 	if (ringbuffer == NULL) {
 		return -1;
@@ -36,11 +40,14 @@ size_t ringbuffer_allocate(ARC_Ringbuffer *ringbuffer, int block) {
 
 	mutex_lock(&ringbuffer->lock);
 
-	if (ringbuffer->idx == ringbuffer->data_tail && block) {
-		while (ringbuffer->idx == ringbuffer->data_tail);
-	} else if (ringbuffer->idx == ringbuffer->data_tail) {
-		mutex_unlock(&ringbuffer->lock);
-		return -2;
+	while (ringbuffer->idx == ringbuffer->data_tail) {
+		if (!block) {
+			mutex_unlock(&ringbuffer->lock);
+			return -2;
+		}
+
+		// Sleep until the consumer frees something
+		condvar_wait(&ringbuffer->space, &ringbuffer->lock);
 	}
 
 	size_t idx = ringbuffer->idx++;
@@ -54,7 +61,10 @@ int ringbuffer_free(ARC_Ringbuffer *ringbuffer, size_t idx) {
 		return -1;
 	}
 
+	mutex_lock(&ringbuffer->lock);
 	ringbuffer->data_tail = idx % ringbuffer->obj_size;
+	condvar_broadcast(&ringbuffer->space);
+	mutex_unlock(&ringbuffer->lock);
 
 	return 0;
 }
@@ -78,11 +88,725 @@ size_t ringbuffer_write(ARC_Ringbuffer *ringbuffer, size_t idx, void *data) {
 	return idx;
 }
 
+static inline void *ringbuffer_slot(ARC_Ringbuffer *ringbuffer, size_t idx) {
+	return ringbuffer->base + (idx * ringbuffer->obj_size);
+}
+
+static int ringbuffer_push_spsc(ARC_Ringbuffer *ringbuffer, void *data) {
+	size_t head = ringbuffer->producer.head;
+
+	if (head - ringbuffer->producer.tail_cache == ringbuffer->objs) {
+		ringbuffer->producer.tail_cache = __atomic_load_n(&ringbuffer->consumer.tail, __ATOMIC_ACQUIRE);
+
+		if (head - ringbuffer->producer.tail_cache == ringbuffer->objs) {
+			return -2;
+		}
+	}
+
+	memcpy(ringbuffer_slot(ringbuffer, head & ringbuffer->mask), data, ringbuffer->obj_size);
+	__atomic_store_n(&ringbuffer->producer.head, head + 1, __ATOMIC_RELEASE);
+
+	return 0;
+}
+
+static int ringbuffer_pop_spsc(ARC_Ringbuffer *ringbuffer, void *data) {
+	size_t tail = ringbuffer->consumer.tail;
+
+	if (tail == ringbuffer->consumer.head_cache) {
+		ringbuffer->consumer.head_cache = __atomic_load_n(&ringbuffer->producer.head, __ATOMIC_ACQUIRE);
+
+		if (tail == ringbuffer->consumer.head_cache) {
+			return -2;
+		}
+	}
+
+	memcpy(data, ringbuffer_slot(ringbuffer, tail & ringbuffer->mask), ringbuffer->obj_size);
+	__atomic_store_n(&ringbuffer->consumer.tail, tail + 1, __ATOMIC_RELEASE);
+
+	return 0;
+}
+
+// NOTE: In MPMC mode object i holds sequence number p when the producer
+//       with position p may fill it, and p + 1 once it has been filled
+//       and the consumer with position p may empty it. Emptying it sets
+//       it to p + objs, the position of the next producer to use it
+static int ringbuffer_push_mpmc(ARC_Ringbuffer *ringbuffer, void *data) {
+	size_t pos = __atomic_load_n(&ringbuffer->producer.head, __ATOMIC_RELAXED);
+
+	for (;;) {
+		size_t seq = __atomic_load_n(&ringbuffer->seq[pos & ringbuffer->mask], __ATOMIC_ACQUIRE);
+		intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+
+		if (diff == 0) {
+			if (__atomic_compare_exchange_n(&ringbuffer->producer.head, &pos, pos + 1, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+				break;
+			}
+		} else if (diff < 0) {
+			// The object is still waiting to be consumed
+			return -2;
+		} else {
+			pos = __atomic_load_n(&ringbuffer->producer.head, __ATOMIC_RELAXED);
+		}
+	}
+
+	memcpy(ringbuffer_slot(ringbuffer, pos & ringbuffer->mask), data, ringbuffer->obj_size);
+	__atomic_store_n(&ringbuffer->seq[pos & ringbuffer->mask], pos + 1, __ATOMIC_RELEASE);
+
+	return 0;
+}
+
+static int ringbuffer_pop_mpmc(ARC_Ringbuffer *ringbuffer, void *data) {
+	size_t pos = __atomic_load_n(&ringbuffer->consumer.tail, __ATOMIC_RELAXED);
+
+	for (;;) {
+		size_t seq = __atomic_load_n(&ringbuffer->seq[pos & ringbuffer->mask], __ATOMIC_ACQUIRE);
+		intptr_t diff = (intptr_t)seq - (intptr_t)(pos + 1);
+
+		if (diff == 0) {
+			if (__atomic_compare_exchange_n(&ringbuffer->consumer.tail, &pos, pos + 1, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+				break;
+			}
+		} else if (diff < 0) {
+			// The object has not been filled yet
+			return -2;
+		} else {
+			pos = __atomic_load_n(&ringbuffer->consumer.tail, __ATOMIC_RELAXED);
+		}
+	}
+
+	memcpy(data, ringbuffer_slot(ringbuffer, pos & ringbuffer->mask), ringbuffer->obj_size);
+	__atomic_store_n(&ringbuffer->seq[pos & ringbuffer->mask], pos + ringbuffer->objs, __ATOMIC_RELEASE);
+
+	return 0;
+}
+
+// NOTE: In OVERWRITE mode an object's sequence is 2p + 1 while the
+//       producer with position p writes it and 2p + 2 once it holds that
+//       producer's object, much like a seqlock per object
+static int ringbuffer_push_overwrite(ARC_Ringbuffer *ringbuffer, void *data) {
+	size_t pos = __atomic_fetch_add(&ringbuffer->producer.head, 1, __ATOMIC_RELAXED);
+	size_t *seq = &ringbuffer->seq[pos & ringbuffer->mask];
+	size_t current = __atomic_load_n(seq, __ATOMIC_RELAXED);
+
+	for (;;) {
+		if (current >= 2 * pos + 1) {
+			// A producer a lap ahead already took the object, this
+			// object would be overwritten straight away
+			return 0;
+		}
+
+		if (current & 1) {
+			// A producer a lap behind is still writing
+			ARC_CPU_RELAX;
+			current = __atomic_load_n(seq, __ATOMIC_RELAXED);
+			continue;
+		}
+
+		if (__atomic_compare_exchange_n(seq, &current, 2 * pos + 1, 1, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+			break;
+		}
+	}
+
+	// Order the odd sequence before the writes to the object
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+	memcpy(ringbuffer_slot(ringbuffer, pos & ringbuffer->mask), data, ringbuffer->obj_size);
+	__atomic_store_n(seq, 2 * pos + 2, __ATOMIC_RELEASE);
+
+	return 0;
+}
+
+int ringbuffer_cursor_init(ARC_Ringbuffer *ringbuffer, ARC_RingbufferCursor *cursor) {
+	if (ringbuffer == NULL || cursor == NULL || ringbuffer->mode != ARC_RINGBUFFER_OVERWRITE) {
+		return 1;
+	}
+
+	size_t head = __atomic_load_n(&ringbuffer->producer.head, __ATOMIC_ACQUIRE);
+
+	cursor->pos = head > ringbuffer->objs ? head - ringbuffer->objs : 0;
+	cursor->missed = 0;
+
+	return 0;
+}
+
+int ringbuffer_read(ARC_Ringbuffer *ringbuffer, ARC_RingbufferCursor *cursor, void *data) {
+	if (ringbuffer == NULL || cursor == NULL || data == NULL || ringbuffer->mode != ARC_RINGBUFFER_OVERWRITE) {
+		return 1;
+	}
+
+	for (;;) {
+		size_t pos = cursor->pos;
+		size_t *seq = &ringbuffer->seq[pos & ringbuffer->mask];
+		size_t before = __atomic_load_n(seq, __ATOMIC_ACQUIRE);
+
+		if (before < 2 * pos + 2) {
+			// Not written yet, or still being written
+			return -2;
+		}
+
+		if (before == 2 * pos + 2) {
+			memcpy(data, ringbuffer_slot(ringbuffer, pos & ringbuffer->mask), ringbuffer->obj_size);
+			__atomic_thread_fence(__ATOMIC_ACQUIRE);
+
+			if (__atomic_load_n(seq, __ATOMIC_RELAXED) == before) {
+				cursor->pos = pos + 1;
+				return 0;
+			}
+		}
+
+		// Overwritten, skip to the oldest object which is not
+		size_t head = __atomic_load_n(&ringbuffer->producer.head, __ATOMIC_ACQUIRE);
+		size_t oldest = head - ringbuffer->objs;
+
+		if (oldest <= pos) {
+			oldest = pos + 1;
+		}
+
+		cursor->missed += oldest - pos;
+		cursor->pos = oldest;
+	}
+}
+
+int ringbuffer_cursor_poll(ARC_Ringbuffer *ringbuffer, ARC_RingbufferCursor *cursor) {
+	if (ringbuffer == NULL || cursor == NULL || ringbuffer->mode != ARC_RINGBUFFER_OVERWRITE) {
+		return 0;
+	}
+
+	// The object at the cursor was written, or overwritten by a later one
+	size_t seq = __atomic_load_n(&ringbuffer->seq[cursor->pos & ringbuffer->mask], __ATOMIC_ACQUIRE);
+
+	return ARC_RINGBUFFER_POLLOUT | (seq >= 2 * cursor->pos + 2 ? ARC_RINGBUFFER_POLLIN : 0);
+}
+
+static int ringbuffer_push_locked(ARC_Ringbuffer *ringbuffer, void *data) {
+	mutex_lock(&ringbuffer->lock);
+
+	size_t head = ringbuffer->producer.head;
+
+	if (head - ringbuffer->consumer.tail == ringbuffer->objs) {
+		mutex_unlock(&ringbuffer->lock);
+		return -2;
+	}
+
+	memcpy(ringbuffer_slot(ringbuffer, head % ringbuffer->objs), data, ringbuffer->obj_size);
+	__atomic_store_n(&ringbuffer->producer.head, head + 1, __ATOMIC_RELEASE);
+
+	mutex_unlock(&ringbuffer->lock);
+
+	return 0;
+}
+
+static int ringbuffer_pop_locked(ARC_Ringbuffer *ringbuffer, void *data) {
+	mutex_lock(&ringbuffer->lock);
+
+	size_t tail = ringbuffer->consumer.tail;
+
+	if (tail == ringbuffer->producer.head) {
+		mutex_unlock(&ringbuffer->lock);
+		return -2;
+	}
+
+	memcpy(data, ringbuffer_slot(ringbuffer, tail % ringbuffer->objs), ringbuffer->obj_size);
+	__atomic_store_n(&ringbuffer->consumer.tail, tail + 1, __ATOMIC_RELEASE);
+
+	mutex_unlock(&ringbuffer->lock);
+
+	return 0;
+}
+
+// Number of objects queued, approximate while the indices are moving
+static inline size_t ringbuffer_used(ARC_Ringbuffer *ringbuffer) {
+	size_t tail = __atomic_load_n(&ringbuffer->consumer.tail, __ATOMIC_ACQUIRE);
+	size_t head = __atomic_load_n(&ringbuffer->producer.head, __ATOMIC_ACQUIRE);
+	size_t used = head - tail;
+
+	// The indices are read one after the other, so they may be from
+	// different moments
+	return used > ringbuffer->objs ? (head < tail ? 0 : ringbuffer->objs) : used;
+}
+
+static int ringbuffer_empty_validate(void *addr, void *arg) {
+	return ringbuffer_used((ARC_Ringbuffer *)arg) == 0;
+}
+
+static int ringbuffer_full_validate(void *addr, void *arg) {
+	ARC_Ringbuffer *ringbuffer = (ARC_Ringbuffer *)arg;
+
+	return ringbuffer_used(ringbuffer) == ringbuffer->objs;
+}
+
+// NOTE: The full fence orders the index update before the check for
+//       sleepers, pairing with the sleeper announcing itself before it
+//       checks the buffer under the park bucket lock
+static void ringbuffer_wake_data(ARC_Ringbuffer *ringbuffer) {
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+	if (__atomic_load_n(&ringbuffer->data_waiters, __ATOMIC_RELAXED) > 0
+	    && ringbuffer_used(ringbuffer) >= ringbuffer->data_watermark) {
+		park_wake(&ringbuffer->producer.head, ARC_PARK_ALL);
+	}
+}
+
+static void ringbuffer_wake_space(ARC_Ringbuffer *ringbuffer) {
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+	if (__atomic_load_n(&ringbuffer->space_waiters, __ATOMIC_RELAXED) > 0
+	    && ringbuffer->objs - ringbuffer_used(ringbuffer) >= ringbuffer->space_watermark) {
+		park_wake(&ringbuffer->consumer.tail, ARC_PARK_ALL);
+	}
+}
+
+int ringbuffer_push(ARC_Ringbuffer *ringbuffer, void *data) {
+	if (ringbuffer == NULL || data == NULL) {
+		return 1;
+	}
+
+	switch (ringbuffer->mode) {
+		case ARC_RINGBUFFER_SPSC: {
+			return ringbuffer_push_spsc(ringbuffer, data);
+		}
+
+		case ARC_RINGBUFFER_MPMC: {
+			return ringbuffer_push_mpmc(ringbuffer, data);
+		}
+
+		case ARC_RINGBUFFER_OVERWRITE: {
+			return ringbuffer_push_overwrite(ringbuffer, data);
+		}
+
+		default: {
+			return ringbuffer_push_locked(ringbuffer, data);
+		}
+	}
+}
+
+int ringbuffer_pop(ARC_Ringbuffer *ringbuffer, void *data) {
+	if (ringbuffer == NULL || data == NULL) {
+		return 1;
+	}
+
+	switch (ringbuffer->mode) {
+		case ARC_RINGBUFFER_SPSC: {
+			return ringbuffer_pop_spsc(ringbuffer, data);
+		}
+
+		case ARC_RINGBUFFER_MPMC: {
+			return ringbuffer_pop_mpmc(ringbuffer, data);
+		}
+
+		case ARC_RINGBUFFER_OVERWRITE: {
+			return 1;
+		}
+
+		default: {
+			return ringbuffer_pop_locked(ringbuffer, data);
+		}
+	}
+}
+
+int ringbuffer_push_wake(ARC_Ringbuffer *ringbuffer, void *data) {
+	int r = ringbuffer_push(ringbuffer, data);
+
+	if (r == 0) {
+		ringbuffer_wake_data(ringbuffer);
+	}
+
+	return r;
+}
+
+int ringbuffer_pop_wake(ARC_Ringbuffer *ringbuffer, void *data) {
+	int r = ringbuffer_pop(ringbuffer, data);
+
+	if (r == 0) {
+		ringbuffer_wake_space(ringbuffer);
+	}
+
+	return r;
+}
+
+static int ringbuffer_push_slow(ARC_Ringbuffer *ringbuffer, void *data, uint64_t deadline) {
+	for (;;) {
+		int r = ringbuffer_push_wake(ringbuffer, data);
+
+		if (r != -2) {
+			return r;
+		}
+
+		__atomic_add_fetch(&ringbuffer->space_waiters, 1, __ATOMIC_SEQ_CST);
+		r = park_wait_cond(&ringbuffer->consumer.tail, ringbuffer_full_validate, ringbuffer, deadline);
+		__atomic_sub_fetch(&ringbuffer->space_waiters, 1, __ATOMIC_RELAXED);
+
+		if (r == -2) {
+			return -2;
+		}
+	}
+}
+
+static int ringbuffer_pop_slow(ARC_Ringbuffer *ringbuffer, void *data, uint64_t deadline) {
+	for (;;) {
+		int r = ringbuffer_pop_wake(ringbuffer, data);
+
+		if (r != -2) {
+			return r;
+		}
+
+		__atomic_add_fetch(&ringbuffer->data_waiters, 1, __ATOMIC_SEQ_CST);
+		r = park_wait_cond(&ringbuffer->producer.head, ringbuffer_empty_validate, ringbuffer, deadline);
+		__atomic_sub_fetch(&ringbuffer->data_waiters, 1, __ATOMIC_RELAXED);
+
+		if (r == -2) {
+			return -2;
+		}
+	}
+}
+
+int ringbuffer_push_wait(ARC_Ringbuffer *ringbuffer, void *data) {
+	if (ringbuffer == NULL || ringbuffer->mode == ARC_RINGBUFFER_OVERWRITE) {
+		return 1;
+	}
+
+	return ringbuffer_push_slow(ringbuffer, data, 0);
+}
+
+int ringbuffer_push_timeout(ARC_Ringbuffer *ringbuffer, void *data, uint64_t timeout) {
+	if (ringbuffer == NULL || ringbuffer->mode == ARC_RINGBUFFER_OVERWRITE) {
+		return 1;
+	}
+
+	return ringbuffer_push_slow(ringbuffer, data, schedhooks_now() + timeout);
+}
+
+int ringbuffer_pop_wait(ARC_Ringbuffer *ringbuffer, void *data) {
+	if (ringbuffer == NULL) {
+		return 1;
+	}
+
+	return ringbuffer_pop_slow(ringbuffer, data, 0);
+}
+
+int ringbuffer_pop_timeout(ARC_Ringbuffer *ringbuffer, void *data, uint64_t timeout) {
+	if (ringbuffer == NULL) {
+		return 1;
+	}
+
+	return ringbuffer_pop_slow(ringbuffer, data, schedhooks_now() + timeout);
+}
+
+int ringbuffer_set_watermarks(ARC_Ringbuffer *ringbuffer, size_t data, size_t space) {
+	if (ringbuffer == NULL || data == 0 || space == 0) {
+		return 1;
+	}
+
+	// A watermark above the size could never be reached
+	ringbuffer->data_watermark = data < ringbuffer->objs ? data : ringbuffer->objs;
+	ringbuffer->space_watermark = space < ringbuffer->objs ? space : ringbuffer->objs;
+
+	return 0;
+}
+
+int ringbuffer_poll(ARC_Ringbuffer *ringbuffer) {
+	if (ringbuffer == NULL) {
+		return 0;
+	}
+
+	// NOTE: Readers do not consume objects in overwrite mode, whether
+	//       there is something to read depends on the cursor
+	if (ringbuffer->mode == ARC_RINGBUFFER_OVERWRITE) {
+		return ARC_RINGBUFFER_POLLOUT;
+	}
+
+	size_t used = ringbuffer_used(ringbuffer);
+	int events = 0;
+
+	if (used > 0) {
+		events |= ARC_RINGBUFFER_POLLIN;
+	}
+
+	if (used < ringbuffer->objs) {
+		events |= ARC_RINGBUFFER_POLLOUT;
+	}
+
+	return events;
+}
+
+static void ringbuffer_span(ARC_Ringbuffer *ringbuffer, size_t pos, size_t total, ARC_RingbufferSpan *span) {
+	size_t idx = pos % ringbuffer->objs;
+	size_t first = ringbuffer->objs - idx;
+
+	// The mirror continues the buffer past its end
+	if (first > total || ringbuffer->mirrored) {
+		first = total;
+	}
+
+	span->pos = pos;
+	span->total = total;
+	span->base[0] = ringbuffer_slot(ringbuffer, idx);
+	span->count[0] = first;
+	span->base[1] = ringbuffer->base;
+	span->count[1] = total - first;
+}
+
+// Count the objects from pos on (up to n) whose sequence is pos + i + offset
+static size_t ringbuffer_mpmc_ready(ARC_Ringbuffer *ringbuffer, size_t pos, size_t n, size_t offset, intptr_t *diff) {
+	size_t count = 0;
+
+	for (; count < n; count++) {
+		size_t seq = __atomic_load_n(&ringbuffer->seq[(pos + count) & ringbuffer->mask], __ATOMIC_ACQUIRE);
+		*diff = (intptr_t)seq - (intptr_t)(pos + count + offset);
+
+		if (*diff != 0) {
+			break;
+		}
+	}
+
+	return count;
+}
+
+static size_t ringbuffer_claim_mpmc(ARC_Ringbuffer *ringbuffer, size_t *index, size_t n, size_t offset, size_t *pos) {
+	*pos = __atomic_load_n(index, __ATOMIC_RELAXED);
+
+	for (;;) {
+		intptr_t diff = 0;
+		size_t count = ringbuffer_mpmc_ready(ringbuffer, *pos, n, offset, &diff);
+
+		if (count == 0) {
+			if (diff < 0) {
+				return 0;
+			}
+
+			*pos = __atomic_load_n(index, __ATOMIC_RELAXED);
+			continue;
+		}
+
+		if (__atomic_compare_exchange_n(index, pos, *pos + count, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+			return count;
+		}
+	}
+}
+
+size_t ringbuffer_reserve(ARC_Ringbuffer *ringbuffer, size_t n, ARC_RingbufferSpan *span) {
+	if (ringbuffer == NULL || span == NULL || n == 0 || ringbuffer->mode == ARC_RINGBUFFER_OVERWRITE) {
+		return 0;
+	}
+
+	size_t pos = 0;
+	size_t count = 0;
+
+	switch (ringbuffer->mode) {
+		case ARC_RINGBUFFER_SPSC: {
+			pos = ringbuffer->producer.head;
+
+			if (ringbuffer->objs - (pos - ringbuffer->producer.tail_cache) < n) {
+				ringbuffer->producer.tail_cache = __atomic_load_n(&ringbuffer->consumer.tail, __ATOMIC_ACQUIRE);
+			}
+
+			count = ringbuffer->objs - (pos - ringbuffer->producer.tail_cache);
+
+			break;
+		}
+
+		case ARC_RINGBUFFER_MPMC: {
+			count = ringbuffer_claim_mpmc(ringbuffer, &ringbuffer->producer.head, n, 0, &pos);
+
+			break;
+		}
+
+		default: {
+			mutex_lock(&ringbuffer->lock);
+			pos = ringbuffer->producer.head;
+			count = ringbuffer->objs - (pos - ringbuffer->consumer.tail);
+
+			if (count == 0) {
+				mutex_unlock(&ringbuffer->lock);
+			}
+
+			break;
+		}
+	}
+
+	if (count > n) {
+		count = n;
+	}
+
+	ringbuffer_span(ringbuffer, pos, count, span);
+
+	return count;
+}
+
+int ringbuffer_commit(ARC_Ringbuffer *ringbuffer, ARC_RingbufferSpan *span) {
+	if (ringbuffer == NULL || span == NULL) {
+		return 1;
+	}
+
+	if (span->total == 0) {
+		return 0;
+	}
+
+	switch (ringbuffer->mode) {
+		case ARC_RINGBUFFER_SPSC: {
+			__atomic_store_n(&ringbuffer->producer.head, span->pos + span->total, __ATOMIC_RELEASE);
+
+			break;
+		}
+
+		case ARC_RINGBUFFER_MPMC: {
+			for (size_t i = 0; i < span->total; i++) {
+				size_t pos = span->pos + i;
+				__atomic_store_n(&ringbuffer->seq[pos & ringbuffer->mask], pos + 1, __ATOMIC_RELEASE);
+			}
+
+			break;
+		}
+
+		default: {
+			__atomic_store_n(&ringbuffer->producer.head, span->pos + span->total, __ATOMIC_RELEASE);
+			mutex_unlock(&ringbuffer->lock);
+
+			break;
+		}
+	}
+
+	return 0;
+}
+
+int ringbuffer_commit_wake(ARC_Ringbuffer *ringbuffer, ARC_RingbufferSpan *span) {
+	int r = ringbuffer_commit(ringbuffer, span);
+
+	if (r == 0) {
+		ringbuffer_wake_data(ringbuffer);
+	}
+
+	return r;
+}
+
+size_t ringbuffer_peek(ARC_Ringbuffer *ringbuffer, size_t n, ARC_RingbufferSpan *span) {
+	if (ringbuffer == NULL || span == NULL || n == 0 || ringbuffer->mode == ARC_RINGBUFFER_OVERWRITE) {
+		return 0;
+	}
+
+	size_t pos = 0;
+	size_t count = 0;
+
+	switch (ringbuffer->mode) {
+		case ARC_RINGBUFFER_SPSC: {
+			pos = ringbuffer->consumer.tail;
+
+			if (ringbuffer->consumer.head_cache - pos < n) {
+				ringbuffer->consumer.head_cache = __atomic_load_n(&ringbuffer->producer.head, __ATOMIC_ACQUIRE);
+			}
+
+			count = ringbuffer->consumer.head_cache - pos;
+
+			break;
+		}
+
+		case ARC_RINGBUFFER_MPMC: {
+			count = ringbuffer_claim_mpmc(ringbuffer, &ringbuffer->consumer.tail, n, 1, &pos);
+
+			break;
+		}
+
+		default: {
+			mutex_lock(&ringbuffer->lock);
+			pos = ringbuffer->consumer.tail;
+			count = ringbuffer->producer.head - pos;
+
+			if (count == 0) {
+				mutex_unlock(&ringbuffer->lock);
+			}
+
+			break;
+		}
+	}
+
+	if (count > n) {
+		count = n;
+	}
+
+	ringbuffer_span(ringbuffer, pos, count, span);
+
+	return count;
+}
+
+int ringbuffer_release(ARC_Ringbuffer *ringbuffer, ARC_RingbufferSpan *span) {
+	if (ringbuffer == NULL || span == NULL) {
+		return 1;
+	}
+
+	if (span->total == 0) {
+		return 0;
+	}
+
+	switch (ringbuffer->mode) {
+		case ARC_RINGBUFFER_SPSC: {
+			__atomic_store_n(&ringbuffer->consumer.tail, span->pos + span->total, __ATOMIC_RELEASE);
+
+			break;
+		}
+
+		case ARC_RINGBUFFER_MPMC: {
+			for (size_t i = 0; i < span->total; i++) {
+				size_t pos = span->pos + i;
+				__atomic_store_n(&ringbuffer->seq[pos & ringbuffer->mask], pos + ringbuffer->objs, __ATOMIC_RELEASE);
+			}
+
+			break;
+		}
+
+		default: {
+			__atomic_store_n(&ringbuffer->consumer.tail, span->pos + span->total, __ATOMIC_RELEASE);
+			mutex_unlock(&ringbuffer->lock);
+
+			break;
+		}
+	}
+
+	return 0;
+}
+
+int ringbuffer_release_wake(ARC_Ringbuffer *ringbuffer, ARC_RingbufferSpan *span) {
+	int r = ringbuffer_release(ringbuffer, span);
+
+	if (r == 0) {
+		ringbuffer_wake_space(ringbuffer);
+	}
+
+	return r;
+}
+
 ARC_Ringbuffer *init_ringbuffer(void *base, size_t objs, size_t obj_size) {
+	return init_ringbuffer_mode(base, objs, obj_size, ARC_RINGBUFFER_LOCKED);
+}
+
+int init_ringbuffer_vm(ARC_RingbufferVMHooks *hooks) {
+	if (hooks == NULL || hooks->map_mirrored == NULL || hooks->unmap_mirrored == NULL) {
+		return 1;
+	}
+
+	memcpy(&ringbuffer_vm, hooks, sizeof(ringbuffer_vm));
+
+	ARC_DEBUG(INFO, "Initialized ringbuffer VM hooks\n");
+
+	return 0;
+}
+
+ARC_Ringbuffer *init_ringbuffer_mode(void *base, size_t objs, size_t obj_size, int mode) {
 	if (objs == 0 || obj_size == 0) {
 		return NULL;
 	}
 
+	int mirrored = (mode & ARC_RINGBUFFER_MIRRORED) != 0;
+	mode &= ~ARC_RINGBUFFER_MIRRORED;
+
+	if (mirrored && (base != NULL || ringbuffer_vm.map_mirrored == NULL)) {
+		ARC_DEBUG(ERR, "Mirrored ringbuffers need VM hooks and no given buffer\n");
+		return NULL;
+	}
+
+	if (mode != ARC_RINGBUFFER_LOCKED && (objs & (objs - 1)) != 0) {
+		ARC_DEBUG(ERR, "Lock-free ringbuffers need a power of two number of objects (got %lu)\n", objs);
+		return NULL;
+	}
+
 	struct ARC_Ringbuffer *ring = (struct ARC_Ringbuffer *)alloc(sizeof(*ring));
 
 	if (ring == NULL) {
@@ -95,9 +819,60 @@ ARC_Ringbuffer *init_ringbuffer(void *base, size_t objs, size_t obj_size) {
 	ring->objs = objs;
 	ring->obj_size = obj_size;
 	ring->data_tail = -1;
+	ring->mode = mode;
+	ring->mirrored = mirrored;
+	ring->mask = objs - 1;
+	ring->data_watermark = 1;
+	ring->space_watermark = 1;
+
+	if (mode == ARC_RINGBUFFER_MPMC || mode == ARC_RINGBUFFER_OVERWRITE) {
+		ring->seq = (size_t *)alloc(objs * sizeof(*ring->seq));
+
+		if (ring->seq == NULL) {
+			free(ring);
+			return NULL;
+		}
+
+		for (size_t i = 0; i < objs; i++) {
+			ring->seq[i] = mode == ARC_RINGBUFFER_MPMC ? i : 0;
+		}
+	}
+
+	if (mirrored) {
+		ring->base = ringbuffer_vm.map_mirrored(objs * obj_size);
+
+		if (ring->base == NULL) {
+			if (ring->seq != NULL) {
+				free(ring->seq);
+			}
+
+			free(ring);
+			return NULL;
+		}
+	}
+
 	init_static_mutex(&ring->lock);
+	init_static_condvar(&ring->space);
 
         ARC_DEBUG(INFO, "Created ringbuffer at %p (%lu objects of size %lu bytes)\n", ring->base, ring->objs, ring->obj_size);
         
 	return ring;
 }
+
+int uninit_ringbuffer(ARC_Ringbuffer *ringbuffer) {
+	if (ringbuffer == NULL) {
+		return 1;
+	}
+
+	if (ringbuffer->seq != NULL) {
+		free(ringbuffer->seq);
+	}
+
+	if (ringbuffer->mirrored) {
+		ringbuffer_vm.unmap_mirrored(ringbuffer->base, ringbuffer->objs * ringbuffer->obj_size);
+	}
+
+	free(ringbuffer);
+
+	return 0;
+}
@@ -0,0 +1,298 @@
+/**
+ * @file rwsem.c
+ *
+ * @author awewsomegamer <awewsomegamer@gmail.com>
+ *
+ * @LICENSE
+ * Arctan-OS/Klib - Generic Kernel Functions and Data Structures
+ * Copyright (C) 2023-2026 awewsomegamer
+ *
+ * This file is part of Arctan-OS/Klib.
+ *
+ * Arctan-OS/Klib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * @DESCRIPTION
+*/
+#include "lib/rwsem.h"
+#include "lib/atomics.h"
+#include "lib/park.h"
+#include "lib/util.h"
+#include "mm/allocator.h"
+#include "mp/scheduler.h"
+
+#include <stdbool.h>
+
+#define RWSEM_WRITER  (1ULL << 62)
+#define RWSEM_WAITERS (1ULL << 61)
+
+struct internal_rwsem_waiter {
+	struct internal_rwsem_waiter *next;
+	bool writer;
+	uint64_t granted;
+};
+
+static inline void rwsem_grant_waiter(struct internal_rwsem_waiter *waiter) {
+	__atomic_store_n(&waiter->granted, 1, __ATOMIC_RELEASE);
+	park_wake(&waiter->granted, 1);
+}
+
+// Hand the semaphore to the front of the queue, or to the readers at the
+// front only. Called with wait_lock held and no holders left (other than
+// a downgrading writer, counted as a reader)
+static void rwsem_grant(ARC_RWSem *sem, bool readers_only) {
+	struct internal_rwsem_waiter *waiter = sem->head;
+	uint64_t count = __atomic_load_n(&sem->count, __ATOMIC_RELAXED) & ~RWSEM_WAITERS;
+
+	if (waiter == NULL) {
+		__atomic_store_n(&sem->count, count, __ATOMIC_RELEASE);
+		return;
+	}
+
+	if (waiter->writer) {
+		if (readers_only) {
+			return;
+		}
+
+		sem->head = waiter->next;
+		if (sem->head == NULL) {
+			sem->tail = NULL;
+		}
+
+		count = RWSEM_WRITER | (sem->head != NULL ? RWSEM_WAITERS : 0);
+		__atomic_store_n(&sem->count, count, __ATOMIC_RELEASE);
+		rwsem_grant_waiter(waiter);
+
+		return;
+	}
+
+	// Let every reader in up to the first writer, so that the writer
+	// is next in line. The readers are counted before any of them runs
+	struct internal_rwsem_waiter *first = waiter;
+	struct internal_rwsem_waiter *last = NULL;
+	while (waiter != NULL && !waiter->writer) {
+		count++;
+		last = waiter;
+		waiter = waiter->next;
+	}
+
+	sem->head = waiter;
+	if (waiter == NULL) {
+		sem->tail = NULL;
+	}
+
+	count |= (sem->head != NULL ? RWSEM_WAITERS : 0);
+	__atomic_store_n(&sem->count, count, __ATOMIC_RELEASE);
+
+	waiter = first;
+	for (;;) {
+		// The waiter may be gone as soon as it is granted
+		struct internal_rwsem_waiter *next = waiter->next;
+		bool done = waiter == last;
+
+		rwsem_grant_waiter(waiter);
+
+		if (done) {
+			break;
+		}
+
+		waiter = next;
+	}
+}
+
+static int rwsem_wait(ARC_RWSem *sem, bool writer) {
+	struct internal_rwsem_waiter waiter = { .next = NULL, .writer = writer, .granted = 0 };
+
+	mutex_lock(&sem->wait_lock);
+
+	uint64_t count = __atomic_load_n(&sem->count, __ATOMIC_RELAXED);
+	while (sem->head == NULL) {
+		// Nobody is queued, the semaphore may be free by now
+		uint64_t desired = 0;
+
+		if (writer && count == 0) {
+			desired = RWSEM_WRITER;
+		} else if (!writer && (count & RWSEM_WRITER) == 0) {
+			desired = count + 1;
+		} else {
+			break;
+		}
+
+		if (__atomic_compare_exchange_n(&sem->count, &count, desired, 0, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+			mutex_unlock(&sem->wait_lock);
+			return 0;
+		}
+	}
+
+	if (sem->tail != NULL) {
+		((struct internal_rwsem_waiter *)sem->tail)->next = &waiter;
+	} else {
+		sem->head = &waiter;
+	}
+	sem->tail = &waiter;
+
+	count = __atomic_fetch_or(&sem->count, RWSEM_WAITERS, __ATOMIC_ACQ_REL);
+
+	// The last holder may have left before the waiters bit was set, in
+	// which case it did not look at the queue
+	if ((count & ~RWSEM_WAITERS) == 0) {
+		rwsem_grant(sem, false);
+	}
+
+	mutex_unlock(&sem->wait_lock);
+
+	while (__atomic_load_n(&waiter.granted, __ATOMIC_ACQUIRE) == 0) {
+		park_wait(&waiter.granted, 0);
+	}
+
+	return 0;
+}
+
+// Called when the last holder has left and threads are queued
+static void rwsem_wake(ARC_RWSem *sem) {
+	mutex_lock(&sem->wait_lock);
+
+	if (__atomic_load_n(&sem->count, __ATOMIC_ACQUIRE) == RWSEM_WAITERS) {
+		rwsem_grant(sem, false);
+	}
+
+	mutex_unlock(&sem->wait_lock);
+}
+
+int init_rwsem(ARC_RWSem **sem) {
+	if (sem == NULL) {
+		return 1;
+	}
+
+	*sem = (ARC_RWSem *)alloc(sizeof(**sem));
+
+	if (*sem == NULL) {
+		return 1;
+	}
+
+	memset(*sem, 0, sizeof(**sem));
+
+	return 0;
+}
+
+int uninit_rwsem(ARC_RWSem *sem) {
+	free(sem);
+
+	return 0;
+}
+
+int init_static_rwsem(ARC_RWSem *sem) {
+	if (sem == NULL) {
+		return 1;
+	}
+
+	memset(sem, 0, sizeof(*sem));
+
+	return 0;
+}
+
+int rwsem_read_trylock(ARC_RWSem *sem) {
+	if (sem == NULL) {
+		return 1;
+	}
+
+	uint64_t count = __atomic_load_n(&sem->count, __ATOMIC_RELAXED);
+
+	while ((count & (RWSEM_WRITER | RWSEM_WAITERS)) == 0) {
+		if (__atomic_compare_exchange_n(&sem->count, &count, count + 1, 0, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+			return 0;
+		}
+	}
+
+	return -1;
+}
+
+int rwsem_read_lock(ARC_RWSem *sem) {
+	if (sem == NULL) {
+		return 1;
+	}
+
+	if (rwsem_read_trylock(sem) == 0) {
+		return 0;
+	}
+
+	return rwsem_wait(sem, false);
+}
+
+int rwsem_read_unlock(ARC_RWSem *sem) {
+	if (sem == NULL) {
+		return 1;
+	}
+
+	if (__atomic_sub_fetch(&sem->count, 1, __ATOMIC_RELEASE) == RWSEM_WAITERS) {
+		rwsem_wake(sem);
+	}
+
+	return 0;
+}
+
+int rwsem_write_trylock(ARC_RWSem *sem) {
+	if (sem == NULL) {
+		return 1;
+	}
+
+	uint64_t expected = 0;
+	if (!__atomic_compare_exchange_n(&sem->count, &expected, RWSEM_WRITER, 0, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+		return -1;
+	}
+
+	return 0;
+}
+
+int rwsem_write_lock(ARC_RWSem *sem) {
+	if (sem == NULL) {
+		return 1;
+	}
+
+	if (rwsem_write_trylock(sem) == 0) {
+		return 0;
+	}
+
+	return rwsem_wait(sem, true);
+}
+
+int rwsem_write_unlock(ARC_RWSem *sem) {
+	if (sem == NULL) {
+		return 1;
+	}
+
+	if (__atomic_sub_fetch(&sem->count, RWSEM_WRITER, __ATOMIC_RELEASE) == RWSEM_WAITERS) {
+		rwsem_wake(sem);
+	}
+
+	return 0;
+}
+
+int rwsem_downgrade(ARC_RWSem *sem) {
+	if (sem == NULL) {
+		return 1;
+	}
+
+	uint64_t expected = RWSEM_WRITER;
+	if (__atomic_compare_exchange_n(&sem->count, &expected, 1, 0, __ATOMIC_RELEASE, __ATOMIC_RELAXED)) {
+		return 0;
+	}
+
+	// Threads are queued, let the readers at the front in as well
+	mutex_lock(&sem->wait_lock);
+	__atomic_store_n(&sem->count, 1 | RWSEM_WAITERS, __ATOMIC_RELEASE);
+	rwsem_grant(sem, true);
+	mutex_unlock(&sem->wait_lock);
+
+	return 0;
+}
@@ -0,0 +1,282 @@
+/**
+ * @file rwspinlock.c
+ *
+ * @author awewsomegamer <awewsomegamer@gmail.com>
+ *
+ * @LICENSE
+ * Arctan-OS/Klib - Generic Kernel Functions and Data Structures
+ * Copyright (C) 2023-2026 awewsomegamer
+ *
+ * This file is part of Arctan-OS/Klib.
+ *
+ * Arctan-OS/Klib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * @DESCRIPTION
+*/
+#include "lib/rwspinlock.h"
+#include "lib/util.h"
+#include "mm/allocator.h"
+
+// NOTE: Every waiting writer spins on a processor, so 15 bits are plenty
+//       for them. The reader count is kept from overflowing into them
+#define RWSPINLOCK_READERS_MASK 0x0000FFFF
+#define RWSPINLOCK_WAITING_ONE  0x00010000
+#define RWSPINLOCK_WAITING_MASK 0x7FFF0000
+#define RWSPINLOCK_WRITER       0x80000000
+
+int init_rwspinlock(ARC_RWSpinlock **lock) {
+	if (lock == NULL) {
+		return 1;
+	}
+
+	*lock = (ARC_RWSpinlock *)alloc(sizeof(**lock));
+
+	if (*lock == NULL) {
+		return 1;
+	}
+
+	memset(*lock, 0, sizeof(**lock));
+
+	return 0;
+}
+
+int uninit_rwspinlock(ARC_RWSpinlock *lock) {
+	free(lock);
+
+	return 0;
+}
+
+int init_static_rwspinlock(ARC_RWSpinlock *lock) {
+	if (lock == NULL) {
+		return 1;
+	}
+
+	memset(lock, 0, sizeof(*lock));
+
+	return 0;
+}
+
+int rwspinlock_read_trylock(ARC_RWSpinlock *lock) {
+	if (lock == NULL) {
+		return 1;
+	}
+
+	uint32_t val = __atomic_load_n(&lock->lock, __ATOMIC_RELAXED);
+
+	while ((val & (RWSPINLOCK_WRITER | RWSPINLOCK_WAITING_MASK)) == 0
+	       && (val & RWSPINLOCK_READERS_MASK) != RWSPINLOCK_READERS_MASK) {
+		if (__atomic_compare_exchange_n(&lock->lock, &val, val + 1, 0, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+			return 0;
+		}
+	}
+
+	return -1;
+}
+
+int rwspinlock_read_lock(ARC_RWSpinlock *lock) {
+	if (lock == NULL) {
+		return 1;
+	}
+
+	while (rwspinlock_read_trylock(lock) != 0) {
+		ARC_CPU_RELAX;
+	}
+
+	return 0;
+}
+
+int rwspinlock_read_unlock(ARC_RWSpinlock *lock) {
+	if (lock == NULL) {
+		return 1;
+	}
+
+	__atomic_fetch_sub(&lock->lock, 1, __ATOMIC_RELEASE);
+
+	return 0;
+}
+
+int rwspinlock_write_trylock(ARC_RWSpinlock *lock) {
+	if (lock == NULL) {
+		return 1;
+	}
+
+	uint32_t val = __atomic_load_n(&lock->lock, __ATOMIC_RELAXED);
+
+	while ((val & (RWSPINLOCK_WRITER | RWSPINLOCK_READERS_MASK)) == 0) {
+		if (__atomic_compare_exchange_n(&lock->lock, &val, val | RWSPINLOCK_WRITER, 0, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+			return 0;
+		}
+	}
+
+	return -1;
+}
+
+int rwspinlock_write_lock(ARC_RWSpinlock *lock) {
+	if (lock == NULL) {
+		return 1;
+	}
+
+	// Announce the writer so that no new readers get in
+	__atomic_fetch_add(&lock->lock, RWSPINLOCK_WAITING_ONE, __ATOMIC_RELAXED);
+
+	uint32_t val = __atomic_load_n(&lock->lock, __ATOMIC_RELAXED);
+
+	for (;;) {
+		if ((val & (RWSPINLOCK_WRITER | RWSPINLOCK_READERS_MASK)) != 0) {
+			ARC_CPU_RELAX;
+			val = __atomic_load_n(&lock->lock, __ATOMIC_RELAXED);
+			continue;
+		}
+
+		uint32_t desired = (val - RWSPINLOCK_WAITING_ONE) | RWSPINLOCK_WRITER;
+		if (__atomic_compare_exchange_n(&lock->lock, &val, desired, 0, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+			break;
+		}
+	}
+
+	return 0;
+}
+
+int rwspinlock_write_unlock(ARC_RWSpinlock *lock) {
+	if (lock == NULL) {
+		return 1;
+	}
+
+	__atomic_fetch_and(&lock->lock, ~RWSPINLOCK_WRITER, __ATOMIC_RELEASE);
+
+	return 0;
+}
+
+int rwspinlock_downgrade(ARC_RWSpinlock *lock) {
+	if (lock == NULL) {
+		return 1;
+	}
+
+	// Clear the writer bit and count the caller as a reader in one go
+	__atomic_fetch_add(&lock->lock, 1 - RWSPINLOCK_WRITER, __ATOMIC_RELEASE);
+
+	return 0;
+}
+
+// Big reader
+
+int init_brspinlock(ARC_BRSpinlock **lock) {
+	if (lock == NULL) {
+		return 1;
+	}
+
+	*lock = (ARC_BRSpinlock *)alloc(sizeof(**lock));
+
+	if (*lock == NULL) {
+		return 1;
+	}
+
+	memset(*lock, 0, sizeof(**lock));
+
+	return 0;
+}
+
+int uninit_brspinlock(ARC_BRSpinlock *lock) {
+	free(lock);
+
+	return 0;
+}
+
+int init_static_brspinlock(ARC_BRSpinlock *lock) {
+	if (lock == NULL) {
+		return 1;
+	}
+
+	memset(lock, 0, sizeof(*lock));
+
+	return 0;
+}
+
+int brspinlock_read_lock(ARC_BRSpinlock *lock) {
+	if (lock == NULL) {
+		return 1;
+	}
+
+	// NOTE: The reader may be migrated before it unlocks, so counters
+	//       of individual processors can go negative, only their sum
+	//       is meaningful. The slot is held in a local so that backing
+	//       off undoes the increment on the same counter
+	uint32_t slot = percpu_id();
+
+	for (;;) {
+		// Sequentially consistent so that either this reader sees the
+		// writer, or the writer sees this reader
+		__atomic_fetch_add(&lock->readers[slot].count, 1, __ATOMIC_SEQ_CST);
+
+		if (__atomic_load_n(&lock->writer, __ATOMIC_SEQ_CST) == 0) {
+			break;
+		}
+
+		__atomic_fetch_sub(&lock->readers[slot].count, 1, __ATOMIC_RELAXED);
+
+		while (__atomic_load_n(&lock->writer, __ATOMIC_RELAXED) != 0) {
+			ARC_CPU_RELAX;
+		}
+	}
+
+	return 0;
+}
+
+int brspinlock_read_unlock(ARC_BRSpinlock *lock) {
+	if (lock == NULL) {
+		return 1;
+	}
+
+	__atomic_fetch_sub(&lock->readers[percpu_id()].count, 1, __ATOMIC_RELEASE);
+
+	return 0;
+}
+
+int brspinlock_write_lock(ARC_BRSpinlock *lock) {
+	if (lock == NULL) {
+		return 1;
+	}
+
+	while (__atomic_test_and_set(&lock->writer, __ATOMIC_SEQ_CST)) {
+		ARC_CPU_RELAX;
+	}
+
+	// Readers which come in from here on back off, wait for the ones
+	// already inside to leave
+	for (;;) {
+		int32_t sum = 0;
+
+		for (int i = 0; i < ARC_PERCPU_MAX; i++) {
+			sum += __atomic_load_n(&lock->readers[i].count, __ATOMIC_ACQUIRE);
+		}
+
+		if (sum == 0) {
+			break;
+		}
+
+		ARC_CPU_RELAX;
+	}
+
+	return 0;
+}
+
+int brspinlock_write_unlock(ARC_BRSpinlock *lock) {
+	if (lock == NULL) {
+		return 1;
+	}
+
+	__atomic_clear(&lock->writer, __ATOMIC_RELEASE);
+
+	return 0;
+}
@@ -0,0 +1,113 @@
+/**
+ * @file schedhooks.c
+ *
+ * @author awewsomegamer <awewsomegamer@gmail.com>
+ *
+ * @LICENSE
+ * Arctan-OS/Klib - Generic Kernel Functions and Data Structures
+ * Copyright (C) 2023-2026 awewsomegamer
+ *
+ * This file is part of Arctan-OS/Klib.
+ *
+ * Arctan-OS/Klib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * @DESCRIPTION
+*/
+#include <lib/schedhooks.h>
+#include <lib/util.h>
+#include <mp/scheduler.h>
+#include <global.h>
+
+static ARC_SchedHooks sched_hooks = { 0 };
+
+int schedhooks_on_cpu(ARC_Thread *thread) {
+	if (thread == NULL) {
+		return 0;
+	}
+
+	if (sched_hooks.on_cpu == NULL) {
+		return 1;
+	}
+
+	return sched_hooks.on_cpu(thread);
+}
+
+int schedhooks_block(uint64_t deadline) {
+	if (sched_hooks.block == NULL) {
+		sched_yield(NULL);
+		return 0;
+	}
+
+	return sched_hooks.block(deadline);
+}
+
+int schedhooks_unblock(ARC_Thread *thread) {
+	if (thread == NULL) {
+		return 1;
+	}
+
+	if (sched_hooks.unblock == NULL) {
+		return 0;
+	}
+
+	return sched_hooks.unblock(thread);
+}
+
+uint64_t schedhooks_now() {
+	if (sched_hooks.now == NULL) {
+		return 0;
+	}
+
+	return sched_hooks.now();
+}
+
+int schedhooks_get_priority(ARC_Thread *thread) {
+	if (thread == NULL || sched_hooks.get_priority == NULL) {
+		return 0;
+	}
+
+	return sched_hooks.get_priority(thread);
+}
+
+int schedhooks_set_priority(ARC_Thread *thread, int priority) {
+	if (thread == NULL) {
+		return 1;
+	}
+
+	if (sched_hooks.set_priority == NULL) {
+		return 0;
+	}
+
+	return sched_hooks.set_priority(thread, priority);
+}
+
+struct ARC_PIState *schedhooks_pi_state(ARC_Thread *thread) {
+	if (thread == NULL || sched_hooks.pi_state == NULL) {
+		return NULL;
+	}
+
+	return sched_hooks.pi_state(thread);
+}
+
+int init_sched_hooks(ARC_SchedHooks *hooks) {
+	if (hooks == NULL) {
+		return 1;
+	}
+
+	memcpy(&sched_hooks, hooks, sizeof(sched_hooks));
+
+	ARC_DEBUG(INFO, "Initialized scheduler hooks\n");
+
+	return 0;
+}
@@ -0,0 +1,149 @@
+/**
+ * @file semaphore.c
+ *
+ * @author awewsomegamer <awewsomegamer@gmail.com>
+ *
+ * @LICENSE
+ * Arctan-OS/Klib - Generic Kernel Functions and Data Structures
+ * Copyright (C) 2023-2026 awewsomegamer
+ *
+ * This file is part of Arctan-OS/Klib.
+ *
+ * Arctan-OS/Klib is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 2
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ *
+ * @DESCRIPTION
+*/
+#include "lib/semaphore.h"
+#include "lib/atomics.h"
+#include "lib/park.h"
+#include "lib/schedhooks.h"
+#include "lib/util.h"
+#include "mm/allocator.h"
+
+#include <stddef.h>
+
+static int semaphore_down_slow(ARC_Semaphore *sem, uint64_t deadline) {
+	int r = 0;
+
+	// NOTE: waiters and count are accessed sequentially consistently, so
+	//       that either semaphore_up sees this waiter or this waiter sees
+	//       the new unit
+	__atomic_add_fetch(&sem->waiters, 1, __ATOMIC_SEQ_CST);
+
+	for (;;) {
+		uint64_t count = __atomic_load_n(&sem->count, __ATOMIC_SEQ_CST);
+
+		if (count > 0) {
+			if (__atomic_compare_exchange_n(&sem->count, &count, count - 1, 0, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+				break;
+			}
+
+			continue;
+		}
+
+		if (park_wait_timeout(&sem->count, 0, deadline) == -2) {
+			r = -2;
+			break;
+		}
+	}
+
+	__atomic_sub_fetch(&sem->waiters, 1, __ATOMIC_RELAXED);
+
+	return r;
+}
+
+int init_semaphore(ARC_Semaphore **sem, uint64_t count) {
+	if (sem == NULL) {
+		return 1;
+	}
+
+	*sem = (ARC_Semaphore *)alloc(sizeof(**sem));
+
+	if (*sem == NULL) {
+		return 1;
+	}
+
+	return init_static_semaphore(*sem, count);
+}
+
+int uninit_semaphore(ARC_Semaphore *sem) {
+	free(sem);
+
+	return 0;
+}
+
+int init_static_semaphore(ARC_Semaphore *sem, uint64_t count) {
+	if (sem == NULL) {
+		return 1;
+	}
+
+	memset(sem, 0, sizeof(*sem));
+	sem->count = count;
+
+	return 0;
+}
+
+int semaphore_trydown(ARC_Semaphore *sem) {
+	if (sem == NULL) {
+		return 1;
+	}
+
+	uint64_t count = __atomic_load_n(&sem->count, __ATOMIC_RELAXED);
+
+	while (count > 0) {
+		if (__atomic_compare_exchange_n(&sem->count, &count, count - 1, 0, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+			return 0;
+		}
+	}
+
+	return -1;
+}
+
+int semaphore_down(ARC_Semaphore *sem) {
+	if (sem == NULL) {
+		return 1;
+	}
+
+	if (semaphore_trydown(sem) == 0) {
+		return 0;
+	}
+
+	return semaphore_down_slow(sem, 0);
+}
+
+int semaphore_down_timeout(ARC_Semaphore *sem, uint64_t timeout) {
+	if (sem == NULL) {
+		return 1;
+	}
+
+	if (semaphore_trydown(sem) == 0) {
+		return 0;
+	}
+
+	return semaphore_down_slow(sem, schedhooks_now() + timeout);
+}
+
+int semaphore_up(ARC_Semaphore *sem) {
+	if (sem == NULL) {
+		return 1;
+	}
+
+	__atomic_add_fetch(&sem->count, 1, __ATOMIC_SEQ_CST);
+
+	if (__atomic_load_n(&sem->waiters, __ATOMIC_SEQ_CST) > 0) {
+		park_wake(&sem->count, 1);
+	}
+
+	return 0;
+}
@@ -25,8 +25,8 @@
  * @DESCRIPTION
 */
 #include "lib/spinlock.h"
-#include "arch/info.h"
-#include "util.h"
+#include "lib/atomics.h"
+#include "lib/irq.h"
 #include "lib/util.h"
 #include "mm/allocator.h"
 
@@ -62,28 +62,82 @@ int init_static_spinlock(ARC_Spinlock *spinlock) {
 	return 0;
 }
 
-int spinlock_lock(ARC_Spinlock *spinlock) {
+int spinlock_lock_raw(ARC_Spinlock *spinlock) {
 	if (spinlock == NULL) {
 		return 1;
 	}
 
-	while (__atomic_test_and_set(&spinlock->lock, __ATOMIC_ACQUIRE));
-	spinlock->interrupts = arch_interrupts_enabled();
-	ARC_DISABLE_INTERRUPT;
+	ARC_LOCKSTAT_START(start);
+
+	if (__atomic_test_and_set(&spinlock->lock, __ATOMIC_ACQUIRE)) {
+		while (__atomic_test_and_set(&spinlock->lock, __ATOMIC_ACQUIRE)) {
+			ARC_CPU_RELAX;
+		}
+
+		ARC_LOCKSTAT_ACQUIRED(&spinlock->lockstat, &lockstat_spinlock_class, start, 1);
+
+		return 0;
+	}
+
+	ARC_LOCKSTAT_ACQUIRED(&spinlock->lockstat, &lockstat_spinlock_class, start, 0);
 
 	return 0;
 }
 
-int spinlock_unlock(ARC_Spinlock *spinlock) {
+int spinlock_unlock_raw(ARC_Spinlock *spinlock) {
 	if (spinlock == NULL) {
 		return 1;
 	}
 
+	ARC_LOCKSTAT_RELEASED(&spinlock->lockstat, &lockstat_spinlock_class);
 	__atomic_clear(&spinlock->lock, __ATOMIC_RELEASE);
 
-	if (spinlock->interrupts) {
-		ARC_ENABLE_INTERRUPT;
+	return 0;
+}
+
+int spinlock_lock_irqsave(ARC_Spinlock *spinlock, ARC_IRQFlags *flags) {
+	if (spinlock == NULL || flags == NULL) {
+		return 1;
 	}
 
+	*flags = irq_save();
+
+	return spinlock_lock_raw(spinlock);
+}
+
+int spinlock_unlock_irqrestore(ARC_Spinlock *spinlock, ARC_IRQFlags flags) {
+	if (spinlock == NULL) {
+		return 1;
+	}
+
+	spinlock_unlock_raw(spinlock);
+	irq_restore(flags);
+
+	return 0;
+}
+
+int spinlock_lock(ARC_Spinlock *spinlock) {
+	if (spinlock == NULL) {
+		return 1;
+	}
+
+	// NOTE: Interrupts are disabled before spinning, so an interrupt
+	//       handler cannot run on this processor while it holds the lock
+	ARC_IRQFlags flags = irq_save();
+	spinlock_lock_raw(spinlock);
+	spinlock->interrupts = flags;
+
+	return 0;
+}
+
+int spinlock_unlock(ARC_Spinlock *spinlock) {
+	if (spinlock == NULL) {
+		return 1;
+	}
+
+	ARC_IRQFlags flags = spinlock->interrupts;
+	spinlock_unlock_raw(spinlock);
+	irq_restore(flags);
+
 	return 0;
 }
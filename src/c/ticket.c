@@ -25,17 +25,20 @@
  * @DESCRIPTION
 */
 #include "global.h"
+#include "lib/atomics.h"
+#include "lib/park.h"
 #include "lib/ticket.h"
 #include "lib/util.h"
 #include "mm/allocator.h"
 #include "mp/scheduler.h"
 
-struct internal_ticket_lock_node {
-	uint64_t tid;
-	uint64_t ticket;
-	struct internal_ticket_lock_node *next;
-	struct ARC_TicketLock *parent;
-};
+// Only park the freezer while its ticket is not yet being served
+static int ticket_drain_validate(void *addr, void *arg) {
+	struct ARC_Ticket *ticket = (struct ARC_Ticket *)arg;
+	struct ARC_TicketLock *head = (struct ARC_TicketLock *)addr;
+
+	return __atomic_load_n(&head->tickets.owner, __ATOMIC_ACQUIRE) != ticket->ticket;
+}
 
 int init_ticket_lock(struct ARC_TicketLock **lock) {
 	*lock = alloc(sizeof(struct ARC_TicketLock));
@@ -44,9 +47,6 @@ int init_ticket_lock(struct ARC_TicketLock **lock) {
 		return 1;
 	}
 
-	// NOTE: This memset initializes the static mutex
-	//       as well, therefore an explicit call to
-	//       init_static_mutex is not needed
 	memset(*lock, 0, sizeof(struct ARC_TicketLock));
 
 	return 0;
@@ -68,42 +68,47 @@ int init_static_ticket_lock(struct ARC_TicketLock *head) {
 	return 0;
 }
 
-void *ticket_lock(struct ARC_TicketLock *head) {
-	if (head == NULL) {
-		return NULL;
+int ticket_lock_node(struct ARC_TicketLock *head, struct ARC_Ticket *ticket) {
+	if (head == NULL || ticket == NULL) {
+		return 1;
 	}
 
-	if (head->is_frozen) {
-		return NULL;
+	// NOTE: A thread which passes this check just as the lock is frozen
+	//       takes a ticket behind the freezer's and so still waits for
+	//       the lock to be released after the thaw
+	uint64_t frozen;
+	while ((frozen = __atomic_load_n(&head->is_frozen, __ATOMIC_ACQUIRE)) != 0) {
+		park_wait(&head->is_frozen, frozen);
 	}
 
-	struct internal_ticket_lock_node *ticket = (struct internal_ticket_lock_node *)alloc(sizeof(*ticket));
-
-	if (ticket == NULL) {
-		return NULL;
-	}
+	ticket->parent = head;
+	ticket->tid = sched_current_thread()->tid;
+	ticket->dynamic = 0;
 
-	memset(ticket, 0, sizeof(*ticket));
+	// Take the next ticket, the carry out of the top half is discarded
+	uint32_t word = __atomic_fetch_add(&head->tickets.word, 1 << 16, __ATOMIC_ACQUIRE);
+	ticket->ticket = (uint16_t)(word >> 16);
 
-	mutex_lock(&head->lock);
+	return 0;
+}
 
-	struct internal_ticket_lock_node *last = (struct internal_ticket_lock_node *)head->last;
+void *ticket_lock(struct ARC_TicketLock *head) {
+	if (head == NULL) {
+		return NULL;
+	}
 
-	ticket->ticket = head->next_ticket++;
-	ticket->parent = head;
-	ARC_Thread *current = sched_current_thread();
-	ticket->tid = current->tid;
-	ticket->next = NULL;
+	struct ARC_Ticket *ticket = (struct ARC_Ticket *)alloc(sizeof(*ticket));
 
-	if (last != NULL) {
-		last->next = ticket;
-	} else {
-		head->next = ticket;
+	if (ticket == NULL) {
+		return NULL;
 	}
 
-	head->last = ticket;
+	if (ticket_lock_node(head, ticket) != 0) {
+		free(ticket);
+		return NULL;
+	}
 
-	mutex_unlock(&head->lock);
+	ticket->dynamic = 1;
 
 	return (void *)ticket;
 }
@@ -111,20 +116,49 @@ void *ticket_lock(struct ARC_TicketLock *head) {
 void ticket_lock_yield(void *ticket) {
 	if (ticket == NULL) {
 		ARC_DEBUG(ERR, "Ticket is NULL\n");
-		// TODO: What to do?
+		return;
 	}
 
-	struct internal_ticket_lock_node *wait_for = (struct internal_ticket_lock_node *)ticket;
-	struct internal_ticket_lock_node *current = (struct internal_ticket_lock_node *)wait_for->parent->next;
+	struct ARC_Ticket *wait_for = (struct ARC_Ticket *)ticket;
+	struct ARC_TicketLock *head = wait_for->parent;
+
+	ARC_LOCKSTAT_START(start);
+
+	if (__atomic_load_n(&head->tickets.owner, __ATOMIC_ACQUIRE) == wait_for->ticket) {
+		ARC_LOCKSTAT_ACQUIRED(&head->lockstat, &lockstat_ticket_class, start, 0);
+		__atomic_store_n(&head->holder, sched_current_thread(), __ATOMIC_RELAXED);
 
-	if (current->ticket == wait_for->ticket) {
 		return;
 	}
 
-	while (current->ticket != wait_for->ticket) {
-		// sched_yield_cpu(current->tid);
-		current = (struct internal_ticket_lock_node *)wait_for->parent->next;
+	for (;;) {
+		uint16_t distance = wait_for->ticket - __atomic_load_n(&head->tickets.owner, __ATOMIC_ACQUIRE);
+
+		if (distance == 0) {
+			break;
+		}
+
+		if (distance > ARC_TICKET_YIELD_DISTANCE) {
+			// Far from the head, give the holder the processor so that
+			// the queue moves instead of burning it here
+			sched_yield(__atomic_load_n(&head->holder, __ATOMIC_RELAXED));
+			continue;
+		}
+
+		// Poll less often the further back in the queue, keeping the
+		// lock's cache line quiet for the waiters about to get it
+		uint32_t relax = 1;
+		if (distance >= ARC_TICKET_BACKOFF_DISTANCE) {
+			relax = (distance - 1) * ARC_TICKET_BACKOFF_UNIT;
+		}
+
+		for (uint32_t i = 0; i < relax; i++) {
+			ARC_CPU_RELAX;
+		}
 	}
+
+	ARC_LOCKSTAT_ACQUIRED(&head->lockstat, &lockstat_ticket_class, start, 1);
+	__atomic_store_n(&head->holder, sched_current_thread(), __ATOMIC_RELAXED);
 }
 
 void *ticket_unlock(void *ticket) {
@@ -132,25 +166,28 @@ void *ticket_unlock(void *ticket) {
 		return NULL;
 	}
 
-	struct internal_ticket_lock_node *lock = (struct internal_ticket_lock_node *)ticket;
+	struct ARC_Ticket *lock = (struct ARC_Ticket *)ticket;
 	struct ARC_TicketLock *head = lock->parent;
 
-	if (head->next != lock) {
+	if (__atomic_load_n(&head->tickets.owner, __ATOMIC_RELAXED) != lock->ticket) {
 		return NULL;
 	}
 
-	mutex_lock(&head->lock);
+	ARC_LOCKSTAT_RELEASED(&head->lockstat, &lockstat_ticket_class);
 
-	head->next = lock->next;
+	// Only the owner writes this half, so a plain release store is enough
+	uint16_t next = lock->ticket + 1;
+	__atomic_store_n(&head->tickets.owner, next, __ATOMIC_RELEASE);
 
-	if (head->next == NULL) {
-		head->next_ticket = 0;
-		head->last = NULL;
+	// Wake a freezer once the queue in front of it has drained
+	uint64_t frozen = __atomic_load_n(&head->is_frozen, __ATOMIC_SEQ_CST);
+	if (frozen != 0 && (uint16_t)frozen == next) {
+		park_wake(head, 1);
 	}
 
-	free(lock);
-
-	mutex_unlock(&head->lock);
+	if (lock->dynamic) {
+		free(lock);
+	}
 
 	return ticket;
 }
@@ -160,23 +197,34 @@ int ticket_lock_freeze(void *ticket) {
 		return -1;
 	}
 
-	struct internal_ticket_lock_node *lock = (struct internal_ticket_lock_node *)ticket;
+	struct ARC_Ticket *lock = (struct ARC_Ticket *)ticket;
 	struct ARC_TicketLock *head = lock->parent;
 
-	if (head->is_frozen == 1) {
+	if (__atomic_load_n(&head->tickets.owner, __ATOMIC_RELAXED) != lock->ticket) {
+		return -1;
+	}
+
+	uint64_t expected = 0;
+	if (!__atomic_compare_exchange_n(&head->is_frozen, &expected, ARC_TICKET_FROZEN, 0, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)) {
 		ARC_DEBUG(ERR, "Lock is already frozen!\n");
 		return -1;
 	}
 
-	head->is_frozen = 1;
+	// Requeue behind the current waiters. The new ticket is published
+	// before the old turn is handed on, so whichever unlock makes it
+	// current sees it and wakes the caller
+	uint16_t old = lock->ticket;
+	uint32_t word = __atomic_fetch_add(&head->tickets.word, 1 << 16, __ATOMIC_ACQUIRE);
+	lock->ticket = (uint16_t)(word >> 16);
 
-	head->next = lock->next;
+	__atomic_store_n(&head->is_frozen, ARC_TICKET_FROZEN | lock->ticket, __ATOMIC_SEQ_CST);
+	__atomic_store_n(&head->tickets.owner, (uint16_t)(old + 1), __ATOMIC_SEQ_CST);
 
-	while (head->next != NULL) {
-		__asm__("pause");
+	while (ticket_drain_validate(head, lock)) {
+		park_wait_cond(head, ticket_drain_validate, lock, 0);
 	}
 
-	head->next = lock;
+	__atomic_store_n(&head->holder, sched_current_thread(), __ATOMIC_RELAXED);
 
 	return 0;
 }
@@ -186,19 +234,26 @@ int ticket_lock_thaw(void *ticket) {
 		return -1;
 	}
 
-	struct internal_ticket_lock_node *lock = (struct internal_ticket_lock_node *)ticket;
+	struct ARC_Ticket *lock = (struct ARC_Ticket *)ticket;
 	struct ARC_TicketLock *head = lock->parent;
 
+	uint64_t frozen = __atomic_load_n(&head->is_frozen, __ATOMIC_RELAXED);
+
 	// Thaw a frozen lock
-	if (head->is_frozen == 0) {
+	if (frozen == 0) {
 		return 0;
 	}
 
-	if (lock->parent->next != lock) {
+	if (frozen != (ARC_TICKET_FROZEN | lock->ticket)) {
+		return -1;
+	}
+
+	if (__atomic_load_n(&head->tickets.owner, __ATOMIC_RELAXED) != lock->ticket) {
 		return -1;
 	}
 
-	head->is_frozen = 0;
+	__atomic_store_n(&head->is_frozen, 0, __ATOMIC_RELEASE);
+	park_wake(&head->is_frozen, ARC_PARK_ALL);
 
 	return 0;
 }